@@ -0,0 +1,79 @@
+extends SceneTree
+# Counts heap allocations on MPVPlayer's steady-state hot path: render,
+# upload and the mpv event drain. Needs the extension built with the probe
+# hooks and the counter from alloc_counter.c preloaded (Linux/glibc):
+#
+#   scons alloc_probe=yes    (or cmake -DGDMPV_ALLOC_PROBE=ON)
+#   cc -O2 -shared -fPIC -o demo/benchmarks/alloc_counter.so demo/benchmarks/alloc_counter.c
+#   LD_PRELOAD=$PWD/demo/benchmarks/alloc_counter.so godot --path demo -s res://benchmarks/alloc_check.gd -- --count=4 --seconds=10
+#
+# Every malloc/calloc/realloc the player's thread makes inside those paths
+# is counted, including ones freed again in the same frame, and including
+# what Godot allocates when it is called from there (Image::set_data,
+# texture updates). Calls into libmpv are excluded. Run it with a real
+# rendering driver: --headless uses the dummy renderer, which skips the
+# texture upload work the upload path exists for, so it is refused.
+# Exits with status 1 if anything was allocated after warmup, 2 if the
+# counter is not loaded or no real renderer is running.
+
+const WARMUP_SEC := 3.0
+
+var count := 1
+var seconds := 10.0
+var media := "av://lavfi:testsrc2=size=1280x720:rate=60"
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--count="):
+			count = int(arg.get_slice("=", 1))
+		elif arg.begins_with("--seconds="):
+			seconds = float(arg.get_slice("=", 1))
+		elif arg.begins_with("--media="):
+			media = arg.substr(arg.find("=") + 1)
+	run()
+
+
+func run() -> void:
+	if not MPVPlayer.get_allocation_counts().available:
+		print("allocation counter not available; build with alloc_probe=yes and preload alloc_counter.so, see the header of this script")
+		quit(2)
+		return
+	if DisplayServer.get_name() == "headless":
+		print("the dummy renderer does not upload textures; run without --headless")
+		quit(2)
+		return
+
+	var players: Array[MPVPlayer] = []
+	for i in count:
+		var player := MPVPlayer.new()
+		root.add_child(player)
+		player.load_file(media)
+		player.play()
+		players.append(player)
+
+	# Buffers are sized and caches filled during warmup; only what follows counts
+	await create_timer(WARMUP_SEC).timeout
+	MPVPlayer.reset_allocation_counts()
+
+	var frames := 0
+	var start := Time.get_ticks_usec()
+	while Time.get_ticks_usec() - start < seconds * 1000000.0:
+		await process_frame
+		frames += 1
+
+	var counts := MPVPlayer.get_allocation_counts()
+	for player in players:
+		player.queue_free()
+
+	print("players: %d  frames: %d  media: %s" % [count, frames, media])
+	print("%-8s %10s %12s" % ["path", "calls", "allocations"])
+	var failed := false
+	for path in ["render", "upload", "events"]:
+		print("%-8s %10d %12d" % [path, counts[path + "_calls"], counts[path]])
+		failed = failed or counts[path] > 0
+	if counts.render_calls == 0 or counts.upload_calls == 0:
+		print("FAIL: no frames went through the hot path")
+		failed = true
+	print("FAIL" if failed else "OK")
+	quit(1 if failed else 0)
@@ -0,0 +1,102 @@
+// Allocation counter for alloc_check.gd, preloaded into Godot:
+//
+//   cc -O2 -shared -fPIC -o demo/benchmarks/alloc_counter.so demo/benchmarks/alloc_counter.c
+//   LD_PRELOAD=$PWD/demo/benchmarks/alloc_counter.so godot --path demo -s res://benchmarks/alloc_check.gd
+//
+// Wraps glibc's allocator and counts the calls a thread makes while
+// MPVPlayer has a scope open around its render, upload or event drain (see
+// src/mpv_alloc_probe.h). Everything else, mpv's own threads and the calls
+// the player makes into libmpv included, passes through uncounted.
+// Linux/glibc only.
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+extern void *__libc_malloc(size_t p_size);
+extern void *__libc_calloc(size_t p_count, size_t p_size);
+extern void *__libc_realloc(void *p_ptr, size_t p_size);
+extern void *__libc_memalign(size_t p_alignment, size_t p_size);
+
+#define SCOPE_MAX 8
+
+// initial-exec: the general TLS model may allocate on first access, which
+// would recurse into malloc.
+static __thread int scope __attribute__((tls_model("initial-exec"))) = -1;
+static __thread int paused __attribute__((tls_model("initial-exec")));
+
+static _Atomic uint64_t allocations[SCOPE_MAX];
+static _Atomic uint64_t scopes[SCOPE_MAX];
+
+static inline void count(void) {
+	if (scope >= 0 && paused == 0) {
+		atomic_fetch_add_explicit(&allocations[scope], 1, memory_order_relaxed);
+	}
+}
+
+void *malloc(size_t p_size) {
+	count();
+	return __libc_malloc(p_size);
+}
+
+void *calloc(size_t p_count, size_t p_size) {
+	count();
+	return __libc_calloc(p_count, p_size);
+}
+
+void *realloc(void *p_ptr, size_t p_size) {
+	count();
+	return __libc_realloc(p_ptr, p_size);
+}
+
+void *memalign(size_t p_alignment, size_t p_size) {
+	count();
+	return __libc_memalign(p_alignment, p_size);
+}
+
+void *aligned_alloc(size_t p_alignment, size_t p_size) {
+	count();
+	return __libc_memalign(p_alignment, p_size);
+}
+
+int posix_memalign(void **r_ptr, size_t p_alignment, size_t p_size) {
+	count();
+	void *ptr = __libc_memalign(p_alignment, p_size);
+	if (!ptr)
+		return ENOMEM;
+	*r_ptr = ptr;
+	return 0;
+}
+
+// Returns 1 if the scope was opened; nested scopes keep the outer one.
+int gdmpv_alloc_scope_begin(int p_scope) {
+	if (scope >= 0 || p_scope < 0 || p_scope >= SCOPE_MAX)
+		return 0;
+	scope = p_scope;
+	atomic_fetch_add_explicit(&scopes[p_scope], 1, memory_order_relaxed);
+	return 1;
+}
+
+void gdmpv_alloc_scope_end(void) {
+	scope = -1;
+}
+
+void gdmpv_alloc_pause(int p_pause) {
+	paused += p_pause ? 1 : -1;
+}
+
+void gdmpv_alloc_read(uint64_t *r_allocations, uint64_t *r_scopes, int p_count) {
+	for (int i = 0; i < p_count && i < SCOPE_MAX; i++) {
+		r_allocations[i] = atomic_load(&allocations[i]);
+		r_scopes[i] = atomic_load(&scopes[i]);
+	}
+}
+
+void gdmpv_alloc_reset(void) {
+	for (int i = 0; i < SCOPE_MAX; i++) {
+		atomic_store(&allocations[i], 0);
+		atomic_store(&scopes[i], 0);
+	}
+}
@@ -0,0 +1,88 @@
+extends SceneTree
+# Loops the same short clip in many MPVPlayers, with and without the clip
+# cache, and compares steady-state cost once every player is past its first
+# pass.
+#
+#   godot --path demo -s res://benchmarks/clip_cache.gd -- --count=24 --media=<short clip>
+#
+# Without --media a 3 second lavfi test pattern is used.
+
+const MEASURE_SEC := 5.0
+
+var count := 24
+var media := "av://lavfi:testsrc2=size=640x360:rate=30:duration=3"
+var release := false
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--count="):
+			count = int(arg.get_slice("=", 1))
+		elif arg.begins_with("--media="):
+			media = arg.substr(arg.find("=") + 1)
+		elif arg == "--release-mpv":
+			release = true
+	run()
+
+
+func run() -> void:
+	var plain := await measure(false)
+	var cached := await measure(true)
+
+	print("players: %d  media: %s  release mpv: %s" % [count, media, release])
+	print("%-10s %16s %14s %10s" % ["", "process ms/frame", "cpu % (proc)", "cached"])
+	for r in [plain, cached]:
+		print("%-10s %16.3f %14.1f %10d" % [r.name, r.process_ms, r.cpu_percent, r.cached])
+	print(MPVClipCache.get_stats())
+	quit()
+
+
+func measure(use_cache: bool) -> Dictionary:
+	MPVClipCache.clear()
+	var players: Array[MPVPlayer] = []
+	for i in count:
+		var player := MPVPlayer.new()
+		player.clip_cache_enabled = use_cache
+		player.clip_cache_release_mpv = release
+		player.custom_minimum_size = Vector2(160, 90)
+		root.add_child(player)
+		player.set_loop(true)
+		player.load_file(media)
+		player.set_volume(0.0)
+		player.play()
+		players.append(player)
+
+	# One full pass plus some slack, so every capture has finished
+	await create_timer(5.0).timeout
+
+	var cpu_before := read_cpu_ticks()
+	var frames := 0
+	var process_sum := 0.0
+	var start := Time.get_ticks_usec()
+	while Time.get_ticks_usec() - start < MEASURE_SEC * 1000000.0:
+		await process_frame
+		process_sum += Performance.get_monitor(Performance.TIME_PROCESS)
+		frames += 1
+	var cpu_ticks := read_cpu_ticks() - cpu_before
+
+	var cached := 0
+	for player in players:
+		cached += 1 if player.is_playing_from_cache() else 0
+		player.queue_free()
+	await create_timer(1.0).timeout
+
+	return {
+		"name": "cached" if use_cache else "decoding",
+		"process_ms": 1000.0 * process_sum / max(frames, 1),
+		# utime + stime are in clock ticks, normally 100 per second
+		"cpu_percent": 100.0 * cpu_ticks / 100.0 / MEASURE_SEC,
+		"cached": cached,
+	}
+
+
+func read_cpu_ticks() -> float:
+	var stat := FileAccess.open("/proc/self/stat", FileAccess.READ)
+	if stat == null:
+		return 0.0
+	var fields := stat.get_line().split(") ")[1].split(" ")
+	return float(fields[11]) + float(fields[12])
@@ -0,0 +1,46 @@
+extends SceneTree
+# Times MPVPlayer's compositing kernels on a synthetic frame, once per
+# instruction set the CPU supports.
+#
+#   godot --headless --path demo -s res://benchmarks/compositor.gd -- --size=1920x1080 --iterations=200
+#
+# The player itself uses the fastest one; that is the one marked with *.
+# Packed alpha is timed out of place, the way the player runs it. Every
+# kernel set, both packed alpha variants included, is first checked byte
+# for byte against the scalar one; the script exits with status 1 if any
+# of them differ.
+
+var width := 1920
+var height := 1080
+var iterations := 200
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--size="):
+			var size := arg.get_slice("=", 1).split("x")
+			width = int(size[0])
+			height = int(size[1])
+		elif arg.begins_with("--iterations="):
+			iterations = int(arg.get_slice("=", 1))
+
+	var verified: Dictionary = MPVPlayer.verify_compositor()
+	var mismatched := verified.keys().filter(func(isa): return not verified[isa])
+	print("matches scalar: %s" % ", ".join(PackedStringArray(verified.keys().filter(func(isa): return verified[isa]))))
+	if not mismatched.is_empty():
+		print("FAIL: output differs from scalar: %s" % ", ".join(PackedStringArray(mismatched)))
+		quit(1)
+		return
+
+	var best := MPVPlayer.get_compositor_isa()
+	print("frame: %dx%d  iterations: %d" % [width, height, iterations])
+	print("%-14s %-8s %10s %10s" % ["mode", "isa", "ms/frame", "speedup"])
+	for mode in [MPVPlayer.COMPOSITE_CHROMA_KEY, MPVPlayer.COMPOSITE_PACKED_ALPHA]:
+		var results: Dictionary = MPVPlayer.benchmark_compositor(mode, width, height, iterations)
+		var scalar: float = results.get("scalar", 0.0)
+		for isa in results:
+			var ms: float = results[isa]
+			print("%-14s %-8s %10.3f %9.2fx" % [
+					"chroma key" if mode == MPVPlayer.COMPOSITE_CHROMA_KEY else "packed alpha",
+					isa + ("*" if isa == best else ""), ms, scalar / ms if ms > 0.0 else 0.0])
+	quit()
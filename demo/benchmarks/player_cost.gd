@@ -0,0 +1,98 @@
+extends SceneTree
+# Compares the per-instance cost of MPVAudioPlayer against MPVPlayer playing
+# the same media.
+#
+#   godot --headless --path demo -s res://benchmarks/player_cost.gd -- --count=24 [--media=<file or url>]
+#
+# Without --media a lavfi test pattern with a sine tone is generated
+# locally. Decoding runs on mpv's own threads, which Godot's process time
+# (Performance.TIME_PROCESS) does not see, so the comparison is made on
+# the CPU time of the whole process (utime + stime) as well. That and
+# resident memory are read from /proc and therefore only reported on Linux.
+
+const WARMUP_SEC := 3.0
+const MEASURE_SEC := 5.0
+
+var count := 16
+var media := "av://lavfi:testsrc2=size=1280x720:rate=30[out0];sine=frequency=440:sample_rate=48000[out1]"
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--count="):
+			count = int(arg.get_slice("=", 1))
+		elif arg.begins_with("--media="):
+			media = arg.substr(arg.find("=") + 1)
+	run()
+
+
+func run() -> void:
+	var video := await measure("MPVPlayer")
+	var audio := await measure("MPVAudioPlayer")
+
+	print("instances: %d  media: %s" % [count, media])
+	print("%-16s %16s %12s %14s" % ["", "process ms/frame", "cpu %", "rss MiB/inst"])
+	for result in [video, audio]:
+		print("%-16s %16.3f %12.1f %14.2f" % [result.name, result.process_ms, result.cpu_percent, result.rss_mib])
+	if video.process_ms > 0.0:
+		print("audio-only process time: %.1f%% of video player" % (100.0 * audio.process_ms / video.process_ms))
+	if video.cpu_percent > 0.0:
+		print("audio-only CPU time: %.1f%% of video player" % (100.0 * audio.cpu_percent / video.cpu_percent))
+	quit()
+
+
+func measure(cls: String) -> Dictionary:
+	var rss_before := read_rss_kib()
+	var players: Array[Node] = []
+	for i in count:
+		var player: Node = ClassDB.instantiate(cls)
+		root.add_child(player)
+		player.load_file(media)
+		player.set_volume(0.0)
+		player.play()
+		players.append(player)
+
+	await create_timer(WARMUP_SEC).timeout
+
+	var frames := 0
+	var process_sum := 0.0
+	var cpu_before := read_cpu_ticks()
+	var start := Time.get_ticks_usec()
+	while Time.get_ticks_usec() - start < MEASURE_SEC * 1000000.0:
+		await process_frame
+		process_sum += Performance.get_monitor(Performance.TIME_PROCESS)
+		frames += 1
+	var elapsed := (Time.get_ticks_usec() - start) / 1000000.0
+	var cpu_ticks := read_cpu_ticks() - cpu_before
+	var rss_after := read_rss_kib()
+
+	for player in players:
+		player.queue_free()
+	await create_timer(1.0).timeout
+
+	return {
+		"name": cls,
+		"process_ms": 1000.0 * process_sum / max(frames, 1),
+		# utime + stime are in clock ticks, normally 100 per second
+		"cpu_percent": 100.0 * cpu_ticks / 100.0 / elapsed,
+		"rss_mib": (rss_after - rss_before) / 1024.0 / count,
+	}
+
+
+func read_rss_kib() -> float:
+	var status := FileAccess.open("/proc/self/status", FileAccess.READ)
+	if status == null:
+		return 0.0
+	while not status.eof_reached():
+		var line := status.get_line()
+		if line.begins_with("VmRSS:"):
+			return float(line.split(" ", false)[1])
+	return 0.0
+
+
+func read_cpu_ticks() -> float:
+	var stat := FileAccess.open("/proc/self/stat", FileAccess.READ)
+	if stat == null:
+		return 0.0
+	var fields := stat.get_line().split(") ")[1].split(" ")
+	return float(fields[11]) + float(fields[12])
@@ -0,0 +1,53 @@
+extends SceneTree
+# Compares frame pacing with and without MPVPlayer's presentation queue.
+#
+#   godot --path demo -s res://benchmarks/presentation_judder.gd -- --queue=3 --media=<file or url>
+#
+# Judder is reported as the variance of how long each video frame stayed on
+# screen; lower is smoother. Needs a window, since vsync drives the cadence.
+
+const WARMUP_SEC := 3.0
+const MEASURE_SEC := 10.0
+
+var queue_size := 3
+var media := "http://commondatastorage.googleapis.com/gtv-videos-bucket/sample/BigBuckBunny.mp4"
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--queue="):
+			queue_size = int(arg.get_slice("=", 1))
+		elif arg.begins_with("--media="):
+			media = arg.substr(arg.find("=") + 1)
+	run()
+
+
+func run() -> void:
+	var results := [await measure(0), await measure(queue_size)]
+
+	print("media: %s" % media)
+	print("%-8s %10s %10s %10s %10s %8s %8s" % ["queue", "mean ms", "var ms2", "min ms", "max ms", "late", "overflow"])
+	for r in results:
+		print("%-8d %10.2f %10.3f %10.2f %10.2f %8d %8d" % [r.queue, r.display_ms_mean, r.display_ms_variance,
+				r.display_ms_min, r.display_ms_max, r.frames_late, r.frames_overflowed])
+	quit()
+
+
+func measure(size: int) -> Dictionary:
+	var player := MPVPlayer.new()
+	player.presentation_queue_size = size
+	player.set_anchors_preset(Control.PRESET_FULL_RECT)
+	root.add_child(player)
+	player.load_file(media)
+	player.set_volume(0.0)
+	player.play()
+
+	await create_timer(WARMUP_SEC).timeout
+	player.reset_presentation_stats()
+	await create_timer(MEASURE_SEC).timeout
+
+	var stats: Dictionary = player.get_presentation_stats()
+	stats["queue"] = size
+	player.queue_free()
+	await create_timer(1.0).timeout
+	return stats
@@ -0,0 +1,63 @@
+extends SceneTree
+# Probes every media file under a directory twice with MPVProber: once with
+# an empty cache and once warm.
+#
+#   godot --headless --path demo -s res://benchmarks/probe_library.gd -- --dir=/path/to/media --jobs=8
+
+const EXTENSIONS := ["mp4", "mkv", "webm", "mov", "avi", "mp3", "flac", "ogg", "opus", "wav", "m4a"]
+
+var dir := "res://"
+var jobs := 0
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--dir="):
+			dir = arg.substr(arg.find("=") + 1)
+		elif arg.begins_with("--jobs="):
+			jobs = int(arg.get_slice("=", 1))
+	run()
+
+
+func run() -> void:
+	var paths := PackedStringArray()
+	collect(dir, paths)
+	if paths.is_empty():
+		print("no media found under %s" % dir)
+		quit()
+		return
+
+	var prober := MPVProber.new()
+	prober.cache_path = "user://benchmarks/probe_cache.json"
+	prober.max_concurrent = jobs
+	root.add_child(prober)
+	prober.clear_cache()
+
+	var cold := await timed_probe(prober, paths)
+	var warm := await timed_probe(prober, paths)
+
+	var failed := 0
+	for info in cold.results.values():
+		failed += 0 if info.ok else 1
+	print("files: %d  failed: %d  jobs: %s" % [paths.size(), failed, jobs if jobs > 0 else "auto"])
+	print("cold: %8.1f ms  (%.2f ms/file)" % [cold.ms, cold.ms / paths.size()])
+	print("warm: %8.1f ms  (%.2f ms/file)" % [warm.ms, warm.ms / paths.size()])
+	quit()
+
+
+func timed_probe(prober: MPVProber, paths: PackedStringArray) -> Dictionary:
+	var start := Time.get_ticks_usec()
+	prober.probe(paths)
+	var results: Dictionary = await prober.all_completed
+	return {"ms": (Time.get_ticks_usec() - start) / 1000.0, "results": results}
+
+
+func collect(path: String, paths: PackedStringArray) -> void:
+	var access := DirAccess.open(path)
+	if access == null:
+		return
+	for file in access.get_files():
+		if file.get_extension().to_lower() in EXTENSIONS:
+			paths.append(path.path_join(file))
+	for sub in access.get_directories():
+		collect(path.path_join(sub), paths)
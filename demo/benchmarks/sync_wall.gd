@@ -0,0 +1,85 @@
+extends SceneTree
+# Runs a wall of MPVPlayers under one MPVSyncGroup and reports how far the
+# followers stray from the master.
+#
+#   godot --path demo -s res://benchmarks/sync_wall.gd -- --count=16 [--media=<file or url>]
+#
+# Without --media a lavfi test pattern is generated locally. Followers start
+# at staggered positions: the first one further off than the hard seek
+# threshold, the rest by a few frames each, so both the hard seek and the
+# speed correction paths are exercised; the run fails if no hard seek
+# happened. Sync is sub-frame when the worst raw per-tick offset, not the
+# smoothed one, stays under half a frame of the source.
+
+const SETTLE_SEC := 10.0
+const MEASURE_SEC := 30.0
+
+var count := 16
+var media := "av://lavfi:testsrc2=size=320x180:rate=30"
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--count="):
+			count = int(arg.get_slice("=", 1))
+		elif arg.begins_with("--media="):
+			media = arg.substr(arg.find("=") + 1)
+	run()
+
+
+func run() -> void:
+	var grid := GridContainer.new()
+	grid.columns = ceili(sqrt(count))
+	grid.set_anchors_preset(Control.PRESET_FULL_RECT)
+	root.add_child(grid)
+
+	var group := MPVSyncGroup.new()
+	root.add_child(group)
+
+	for i in count:
+		var player := MPVPlayer.new()
+		player.custom_minimum_size = Vector2(160, 90)
+		player.scheduled_rendering = true
+		grid.add_child(player)
+		player.load_file(media)
+		player.set_volume(0.0)
+		player.play()
+		group.add_member(player)
+		if i == 0:
+			group.set_master(player)
+
+	await create_timer(2.0).timeout
+	var followers: Array = group.get_members().slice(1)
+	for i in followers.size():
+		var offset := group.hard_seek_threshold * 3.0 if i == 0 else 0.02 * i
+		followers[i].seek(str(offset), true)
+
+	await create_timer(SETTLE_SEC).timeout
+	var settle_seeks: int = group.get_stats().hard_seeks
+	group.reset_stats()
+
+	var fps: float = group.get_master().get_mpv_property("container-fps")
+	var worst := 0.0
+	var start := Time.get_ticks_usec()
+	while Time.get_ticks_usec() - start < MEASURE_SEC * 1000000.0:
+		await process_frame
+		worst = max(worst, group.get_stats().max_raw_offset_ms)
+
+	print("players: %d  media: %s" % [count, media])
+	print("%-4s %12s %12s %10s %8s %8s" % ["#", "offset ms", "max abs ms", "in tol", "speed", "seeks"])
+	var i := 0
+	for stats in group.get_member_stats():
+		if not stats.master:
+			print("%-4d %12.2f %12.2f %9.1f%% %8.4f %8d" % [i, stats.offset_ms, stats.max_abs_offset_ms,
+					100.0 * stats.in_tolerance_ratio, stats.speed, stats.hard_seeks])
+		i += 1
+
+	var half_frame_ms := 500.0 / fps if fps > 0.0 else 1000.0 / 60.0
+	print("hard seeks while settling: %d" % settle_seeks)
+	print("worst raw offset: %.2f ms (half a frame: %.2f ms) -> %s" % [worst, half_frame_ms,
+			"sub-frame" if worst < half_frame_ms else "NOT sub-frame"])
+	if settle_seeks == 0:
+		print("FAIL: the hard seek path was never taken")
+		quit(1)
+		return
+	quit(0 if worst < half_frame_ms else 1)
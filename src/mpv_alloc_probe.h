@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(MPV_ALLOC_PROBE) && defined(__linux__)
+#include <dlfcn.h>
+#endif
+
+// Hooks for demo/benchmarks/alloc_counter.c, a preloadable malloc counter.
+// When it is loaded, allocations a thread makes inside a Section are
+// counted per section. Calls into libmpv are wrapped in a Pause: what mpv
+// allocates internally is not the player's to remove.
+//
+// Only compiled in when MPV_ALLOC_PROBE is defined (alloc_probe=yes with
+// SCons, -DGDMPV_ALLOC_PROBE=ON with CMake); otherwise Section and Pause
+// are empty and the counts always read as unavailable.
+class MPVAllocProbe {
+public:
+	enum Scope {
+		SCOPE_RENDER,
+		SCOPE_UPLOAD,
+		SCOPE_EVENTS,
+		SCOPE_MAX,
+	};
+
+#ifdef MPV_ALLOC_PROBE
+
+	static bool is_available() { return get_hooks().begin != nullptr; }
+
+	static void read(uint64_t *r_allocations, uint64_t *r_scopes) {
+		if (get_hooks().read) {
+			get_hooks().read(r_allocations, r_scopes, SCOPE_MAX);
+		}
+	}
+
+	static void reset() {
+		if (get_hooks().reset) {
+			get_hooks().reset();
+		}
+	}
+
+	class Section {
+		bool active;
+
+	public:
+		explicit Section(Scope p_scope) :
+				active(get_hooks().begin && get_hooks().begin(p_scope)) {}
+		~Section() {
+			if (active) {
+				get_hooks().end();
+			}
+		}
+	};
+
+	class Pause {
+	public:
+		Pause() {
+			if (get_hooks().pause) {
+				get_hooks().pause(1);
+			}
+		}
+		~Pause() {
+			if (get_hooks().pause) {
+				get_hooks().pause(0);
+			}
+		}
+	};
+
+private:
+	struct Hooks {
+		int (*begin)(int) = nullptr;
+		void (*end)() = nullptr;
+		void (*pause)(int) = nullptr;
+		void (*read)(uint64_t *, uint64_t *, int) = nullptr;
+		void (*reset)() = nullptr;
+	};
+
+	static const Hooks &get_hooks() {
+		static const Hooks hooks = [] {
+			Hooks found;
+#if defined(__linux__)
+			found.begin = (int (*)(int))dlsym(RTLD_DEFAULT, "gdmpv_alloc_scope_begin");
+			found.end = (void (*)())dlsym(RTLD_DEFAULT, "gdmpv_alloc_scope_end");
+			found.pause = (void (*)(int))dlsym(RTLD_DEFAULT, "gdmpv_alloc_pause");
+			found.read = (void (*)(uint64_t *, uint64_t *, int))dlsym(RTLD_DEFAULT, "gdmpv_alloc_read");
+			found.reset = (void (*)())dlsym(RTLD_DEFAULT, "gdmpv_alloc_reset");
+			if (!found.begin || !found.end || !found.pause || !found.read || !found.reset) {
+				found = Hooks();
+			}
+#endif
+			return found;
+		}();
+		return hooks;
+	}
+#else
+	static bool is_available() { return false; }
+	static void read(uint64_t *, uint64_t *) {}
+	static void reset() {}
+
+	class Section {
+	public:
+		explicit Section(Scope) {}
+	};
+
+	class Pause {
+	public:
+		Pause() {}
+	};
+#endif
+};
@@ -0,0 +1,325 @@
+#include "mpv_audio_player.h"
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <cstring>
+
+MPVAudioPlayer::MPVAudioPlayer() {
+	initialize_mpv();
+}
+
+MPVAudioPlayer::~MPVAudioPlayer() {
+	cleanup_mpv();
+}
+
+void MPVAudioPlayer::initialize_mpv() {
+	mpv = mpv_create();
+	if (!mpv) {
+		UtilityFunctions::push_error("MPV: Failed to create MPV instance");
+		return;
+	}
+
+	// No video pipeline at all: nothing is decoded, scaled or rendered.
+	mpv_set_option_string(mpv, "vid", "no");
+	mpv_set_option_string(mpv, "vo", "null");
+	mpv_set_option_string(mpv, "sid", "no");
+	mpv_set_option_string(mpv, "audio-display", "no");
+	mpv_set_option_string(mpv, "osd-level", "0");
+
+	mpv_set_option_string(mpv, "audio-client-name", "Godot MPV Player");
+	mpv_set_option_string(mpv, "keep-open", "yes");
+
+	mpv_set_option_string(mpv, "network-timeout", "60");
+	mpv_set_option_string(mpv, "user-agent", "Stremio");
+	mpv_set_option_string(mpv, "demuxer-readahead-secs", "20");
+	mpv_set_option_string(mpv, "cache", "yes");
+	mpv_set_option_string(mpv, "cache-secs", "15");
+
+	int ret = mpv_initialize(mpv);
+	if (ret < 0) {
+		UtilityFunctions::push_error(vformat("MPV: Failed to initialize MPV: %s", mpv_error_string(ret)));
+		mpv_terminate_destroy(mpv);
+		mpv = nullptr;
+		return;
+	}
+
+	mpv_observe_property(mpv, 0, "time-pos", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(mpv, 1, "pause", MPV_FORMAT_FLAG);
+	mpv_observe_property(mpv, 2, "paused-for-cache", MPV_FORMAT_FLAG);
+	mpv_observe_property(mpv, 3, "duration", MPV_FORMAT_DOUBLE);
+
+	mpv_set_wakeup_callback(mpv, on_mpv_wakeup, this);
+}
+
+void MPVAudioPlayer::cleanup_mpv() {
+	if (mpv) {
+		mpv_set_wakeup_callback(mpv, nullptr, nullptr);
+		mpv_terminate_destroy(mpv);
+		mpv = nullptr;
+	}
+}
+
+void MPVAudioPlayer::on_mpv_wakeup(void *ctx) {
+	// Called from mpv's thread. Coalesce wakeups into a single deferred drain.
+	MPVAudioPlayer *player = static_cast<MPVAudioPlayer *>(ctx);
+	if (!player->drain_queued.exchange(true)) {
+		player->call_deferred("_drain_events");
+	}
+}
+
+void MPVAudioPlayer::_drain_events() {
+	drain_queued.store(false);
+
+	while (mpv) {
+		mpv_event *event = mpv_wait_event(mpv, 0);
+		if (event->event_id == MPV_EVENT_NONE)
+			break;
+
+		switch (event->event_id) {
+			case MPV_EVENT_END_FILE: {
+				mpv_event_end_file *ef = (mpv_event_end_file *)event->data;
+				if (ef->reason == MPV_END_FILE_REASON_EOF) {
+					emit_signal("playback_finished");
+				} else if (ef->reason == MPV_END_FILE_REASON_ERROR) {
+					UtilityFunctions::push_error(vformat("MPV: Playback error: %s", mpv_error_string(ef->error)));
+				}
+				break;
+			}
+			case MPV_EVENT_FILE_LOADED:
+				emit_signal("file_loaded");
+				break;
+			case MPV_EVENT_PROPERTY_CHANGE: {
+				mpv_event_property *prop = static_cast<mpv_event_property *>(event->data);
+				if (!prop || !prop->data)
+					break;
+				switch (event->reply_userdata) {
+					case 0:
+						current_time = *static_cast<double *>(prop->data);
+						break;
+					case 1:
+						paused = *static_cast<int *>(prop->data) != 0;
+						break;
+					case 2: {
+						bool paused_for_cache = *static_cast<int *>(prop->data) != 0;
+						if (paused_for_cache && !is_buffering) {
+							is_buffering = true;
+							emit_signal("buffering_started");
+						} else if (!paused_for_cache && is_buffering) {
+							is_buffering = false;
+							emit_signal("buffering_ended");
+						}
+						break;
+					}
+					case 3:
+						duration = *static_cast<double *>(prop->data);
+						break;
+				}
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
+
+void MPVAudioPlayer::load_file(const String &p_path) {
+	if (!mpv) {
+		UtilityFunctions::push_error("MPV: Cannot load file, mpv not initialized");
+		return;
+	}
+
+	CharString path = p_path.utf8();
+	const char *cmd[] = { "loadfile", path.get_data(), nullptr };
+	int ret = mpv_command(mpv, cmd);
+	if (ret < 0) {
+		UtilityFunctions::push_error(vformat("MPV: Failed to load file: %s", mpv_error_string(ret)));
+	}
+}
+
+void MPVAudioPlayer::play() {
+	if (!mpv)
+		return;
+	const char *cmd[] = { "set", "pause", "no", nullptr };
+	mpv_command_async(mpv, 0, cmd);
+}
+
+void MPVAudioPlayer::pause() {
+	if (!mpv)
+		return;
+	const char *cmd[] = { "set", "pause", "yes", nullptr };
+	mpv_command_async(mpv, 0, cmd);
+}
+
+void MPVAudioPlayer::stop() {
+	if (!mpv)
+		return;
+	const char *cmd[] = { "stop", nullptr };
+	mpv_command_async(mpv, 0, cmd);
+	current_time = 0.0;
+}
+
+void MPVAudioPlayer::seek(String seconds, bool relative) {
+	if (!mpv)
+		return;
+	CharString seconds_cs = seconds.utf8();
+	const char *cmd[] = { "seek", seconds_cs.get_data(), relative ? "relative" : "absolute", nullptr };
+	mpv_command_async(mpv, 0, cmd);
+}
+
+void MPVAudioPlayer::set_volume(double p_volume) {
+	if (!mpv)
+		return;
+	mpv_set_property_async(mpv, 0, "volume", MPV_FORMAT_DOUBLE, &p_volume);
+}
+
+double MPVAudioPlayer::get_volume() const {
+	double value = 0.0;
+	if (mpv) {
+		mpv_get_property(mpv, "volume", MPV_FORMAT_DOUBLE, &value);
+	}
+	return value;
+}
+
+void MPVAudioPlayer::set_loop(bool p_loop) {
+	if (!mpv)
+		return;
+	mpv_set_property_string(mpv, "loop", p_loop ? "inf" : "no");
+}
+
+bool MPVAudioPlayer::get_loop() const {
+	if (!mpv)
+		return false;
+	char *value = mpv_get_property_string(mpv, "loop");
+	bool looping = value && strcmp(value, "inf") == 0;
+	mpv_free(value);
+	return looping;
+}
+
+void MPVAudioPlayer::set_audio_track(String id) {
+	if (!mpv) {
+		ERR_PRINT("MPV not initialized");
+		return;
+	}
+	CharString id_cs = id.utf8();
+	const char *cmd[] = { "set", "aid", id_cs.get_data(), nullptr };
+	mpv_command_async(mpv, 0, cmd);
+}
+
+Array MPVAudioPlayer::get_audio_tracks() {
+	Array tracks;
+
+	if (!mpv) {
+		return tracks;
+	}
+
+	mpv_node track_list;
+	if (mpv_get_property(mpv, "track-list", MPV_FORMAT_NODE, &track_list) < 0) {
+		return tracks;
+	}
+
+	if (track_list.format != MPV_FORMAT_NODE_ARRAY) {
+		mpv_free_node_contents(&track_list);
+		return tracks;
+	}
+
+	for (int i = 0; i < track_list.u.list->num; i++) {
+		mpv_node *track = &track_list.u.list->values[i];
+
+		if (track->format != MPV_FORMAT_NODE_MAP) {
+			continue;
+		}
+
+		Dictionary track_info;
+		const char *type = nullptr;
+
+		for (int j = 0; j < track->u.list->num; j++) {
+			const char *key = track->u.list->keys[j];
+			mpv_node *value = &track->u.list->values[j];
+
+			if (strcmp(key, "type") == 0 && value->format == MPV_FORMAT_STRING) {
+				type = value->u.string;
+			} else if (strcmp(key, "id") == 0 && value->format == MPV_FORMAT_INT64) {
+				track_info["id"] = (int)value->u.int64;
+			} else if (strcmp(key, "lang") == 0 && value->format == MPV_FORMAT_STRING) {
+				track_info["lang"] = String::utf8(value->u.string);
+			} else if (strcmp(key, "title") == 0 && value->format == MPV_FORMAT_STRING) {
+				track_info["title"] = String::utf8(value->u.string);
+			} else if (strcmp(key, "selected") == 0 && value->format == MPV_FORMAT_FLAG) {
+				track_info["selected"] = (bool)value->u.flag;
+			}
+		}
+
+		if (type && strcmp(type, "audio") == 0) {
+			tracks.append(track_info);
+		}
+	}
+
+	mpv_free_node_contents(&track_list);
+	return tracks;
+}
+
+void MPVAudioPlayer::set_mpv_property(const String &p_property, const Variant &p_value) {
+	if (!mpv)
+		return;
+
+	CharString name = p_property.utf8();
+	switch (p_value.get_type()) {
+		case Variant::BOOL:
+		case Variant::INT: {
+			int64_t val = p_value.operator int64_t();
+			mpv_set_property(mpv, name.get_data(), MPV_FORMAT_INT64, &val);
+			break;
+		}
+		case Variant::FLOAT: {
+			double val = p_value.operator double();
+			mpv_set_property(mpv, name.get_data(), MPV_FORMAT_DOUBLE, &val);
+			break;
+		}
+		case Variant::STRING: {
+			CharString val = p_value.operator String().utf8();
+			mpv_set_property_string(mpv, name.get_data(), val.get_data());
+			break;
+		}
+		default:
+			UtilityFunctions::push_warning("Unsupported property type");
+			break;
+	}
+}
+
+void MPVAudioPlayer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_drain_events"), &MPVAudioPlayer::_drain_events);
+
+	// Playback methods
+	ClassDB::bind_method(D_METHOD("load_file", "path"), &MPVAudioPlayer::load_file);
+	ClassDB::bind_method(D_METHOD("play"), &MPVAudioPlayer::play);
+	ClassDB::bind_method(D_METHOD("pause"), &MPVAudioPlayer::pause);
+	ClassDB::bind_method(D_METHOD("stop"), &MPVAudioPlayer::stop);
+	ClassDB::bind_method(D_METHOD("seek", "seconds", "relative"), &MPVAudioPlayer::seek);
+
+	// Property methods
+	ClassDB::bind_method(D_METHOD("get_position"), &MPVAudioPlayer::get_position);
+	ClassDB::bind_method(D_METHOD("get_duration"), &MPVAudioPlayer::get_duration);
+	ClassDB::bind_method(D_METHOD("is_playing"), &MPVAudioPlayer::is_playing);
+	ClassDB::bind_method(D_METHOD("is_paused"), &MPVAudioPlayer::is_paused);
+
+	// Volume and loop
+	ClassDB::bind_method(D_METHOD("set_volume", "volume"), &MPVAudioPlayer::set_volume);
+	ClassDB::bind_method(D_METHOD("get_volume"), &MPVAudioPlayer::get_volume);
+	ClassDB::bind_method(D_METHOD("set_loop", "loop"), &MPVAudioPlayer::set_loop);
+	ClassDB::bind_method(D_METHOD("get_loop"), &MPVAudioPlayer::get_loop);
+
+	ClassDB::bind_method(D_METHOD("set_audio_track", "id"), &MPVAudioPlayer::set_audio_track);
+	ClassDB::bind_method(D_METHOD("get_audio_tracks"), &MPVAudioPlayer::get_audio_tracks);
+	ClassDB::bind_method(D_METHOD("set_mpv_property", "property", "value"), &MPVAudioPlayer::set_mpv_property);
+
+	// Properties
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "volume", PROPERTY_HINT_RANGE, "0,100"), "set_volume", "get_volume");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "loop"), "set_loop", "get_loop");
+
+	// Signals
+	ADD_SIGNAL(MethodInfo("playback_finished"));
+	ADD_SIGNAL(MethodInfo("file_loaded"));
+
+	ADD_SIGNAL(MethodInfo("buffering_started"));
+	ADD_SIGNAL(MethodInfo("buffering_ended"));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mpv/client.h>
+#include <godot_cpp/classes/node.hpp>
+
+#include <atomic>
+
+using namespace godot;
+
+// Audio-only counterpart of MPVPlayer. mpv runs with vid=no/vo=null and no
+// render context, and the node has no per-frame processing: events are
+// drained only when mpv's wakeup callback fires.
+class MPVAudioPlayer : public Node {
+	GDCLASS(MPVAudioPlayer, Node)
+
+private:
+	mpv_handle *mpv = nullptr;
+
+	double current_time = 0.0;
+	double duration = 0.0;
+	bool paused = true;
+	bool is_buffering = false;
+	std::atomic<bool> drain_queued{ false };
+
+	void initialize_mpv();
+	void cleanup_mpv();
+	void _drain_events();
+	static void on_mpv_wakeup(void *ctx);
+
+protected:
+	static void _bind_methods();
+
+public:
+	MPVAudioPlayer();
+	~MPVAudioPlayer() override;
+
+	// Playback control
+	void load_file(const String &p_path);
+	void play();
+	void pause();
+	void stop();
+	void seek(String seconds, bool relative);
+
+	// Property getters
+	double get_position() const { return current_time; }
+	double get_duration() const { return duration; }
+	bool is_playing() const { return !paused; }
+	bool is_paused() const { return paused; }
+
+	// Settings
+	void set_volume(double p_volume);
+	double get_volume() const;
+	void set_loop(bool p_loop);
+	bool get_loop() const;
+
+	void set_audio_track(String id);
+	Array get_audio_tracks();
+
+	// Advanced MPV options
+	void set_mpv_property(const String &p_property, const Variant &p_value);
+};
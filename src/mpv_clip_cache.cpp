@@ -0,0 +1,156 @@
+#include "mpv_clip_cache.h"
+
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef MPV_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+MPVClipCache *MPVClipCache::singleton = nullptr;
+
+int MPVCachedClip::find_frame(double p_time) const {
+	// Last frame that starts at or before p_time
+	auto it = std::upper_bound(frames.begin(), frames.end(), p_time, [](double p_t, const Frame &p_frame) {
+		return p_t < p_frame.start;
+	});
+	return MAX(0, (int)(it - frames.begin()) - 1);
+}
+
+MPVClipDecoder::~MPVClipDecoder() {
+#ifdef MPV_HAVE_ZSTD
+	ZSTD_freeDCtx(context);
+#endif
+}
+
+bool MPVClipDecoder::decode(const MPVCachedClip &p_clip, int p_index, uint8_t *r_pixels) {
+	const PackedByteArray &pixels = p_clip.frames[p_index].pixels;
+	if (!p_clip.compressed) {
+		memcpy(r_pixels, pixels.ptr(), p_clip.frame_size);
+		return true;
+	}
+
+#ifdef MPV_HAVE_ZSTD
+	// PackedByteArray::compress(COMPRESSION_ZSTD) writes a plain zstd frame
+	if (!context) {
+		context = ZSTD_createDCtx();
+		if (!context)
+			return false;
+	}
+	size_t size = ZSTD_decompressDCtx(context, r_pixels, p_clip.frame_size, pixels.ptr(), pixels.size());
+	return !ZSTD_isError(size) && (int64_t)size == p_clip.frame_size;
+#else
+	PackedByteArray decompressed = pixels.decompress(p_clip.frame_size, FileAccess::COMPRESSION_ZSTD);
+	if (decompressed.size() != p_clip.frame_size)
+		return false;
+	memcpy(r_pixels, decompressed.ptr(), p_clip.frame_size);
+	return true;
+#endif
+}
+
+MPVClipCache::MPVClipCache() {
+	singleton = this;
+}
+
+MPVClipCache::~MPVClipCache() {
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+std::shared_ptr<MPVCachedClip> MPVClipCache::acquire(const String &p_key) {
+	auto it = clips.find(p_key);
+	if (it == clips.end()) {
+		misses++;
+		return nullptr;
+	}
+	hits++;
+	it->second->last_used = ++use_counter;
+	return it->second;
+}
+
+bool MPVClipCache::evict(int64_t p_needed) {
+	while (bytes + p_needed > memory_budget) {
+		// Least recently used clip nobody is playing; the cache's own
+		// reference is the only one left for those.
+		auto victim = clips.end();
+		for (auto it = clips.begin(); it != clips.end(); ++it) {
+			if (it->second.use_count() == 1 && (victim == clips.end() || it->second->last_used < victim->second->last_used)) {
+				victim = it;
+			}
+		}
+		if (victim == clips.end())
+			return false;
+
+		bytes -= victim->second->bytes;
+		clips.erase(victim);
+		evictions++;
+	}
+	return true;
+}
+
+std::shared_ptr<MPVCachedClip> MPVClipCache::insert(const String &p_key, const std::shared_ptr<MPVCachedClip> &p_clip) {
+	ERR_FAIL_COND_V(!p_clip || p_clip->frames.empty(), nullptr);
+
+	auto existing = clips.find(p_key);
+	if (existing != clips.end()) {
+		// Another player finished capturing the same clip first; the caller
+		// switches to that one so only one copy stays in memory.
+		existing->second->last_used = ++use_counter;
+		return existing->second;
+	}
+
+	if (p_clip->bytes > memory_budget || !evict(p_clip->bytes)) {
+		rejected++;
+		return nullptr;
+	}
+
+	p_clip->last_used = ++use_counter;
+	clips[p_key] = p_clip;
+	bytes += p_clip->bytes;
+	return p_clip;
+}
+
+void MPVClipCache::set_memory_budget_mb(double p_megabytes) {
+	memory_budget = (int64_t)(MAX(0.0, p_megabytes) * 1024.0 * 1024.0);
+	evict(0);
+}
+
+void MPVClipCache::clear() {
+	// Players keep their own reference to whatever they are playing
+	clips.clear();
+	bytes = 0;
+}
+
+Dictionary MPVClipCache::get_stats() const {
+	int64_t frames = 0;
+	int in_use = 0;
+	for (const auto &entry : clips) {
+		frames += (int64_t)entry.second->frames.size();
+		in_use += entry.second.use_count() > 1 ? 1 : 0;
+	}
+
+	Dictionary stats;
+	stats["clips"] = (int64_t)clips.size();
+	stats["clips_in_use"] = in_use;
+	stats["frames"] = frames;
+	stats["bytes"] = bytes;
+	stats["memory_budget"] = memory_budget;
+	stats["hits"] = hits;
+	stats["misses"] = misses;
+	stats["evictions"] = evictions;
+	stats["rejected"] = rejected;
+	return stats;
+}
+
+void MPVClipCache::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_memory_budget_mb", "megabytes"), &MPVClipCache::set_memory_budget_mb);
+	ClassDB::bind_method(D_METHOD("get_memory_budget_mb"), &MPVClipCache::get_memory_budget_mb);
+	ClassDB::bind_method(D_METHOD("clear"), &MPVClipCache::clear);
+	ClassDB::bind_method(D_METHOD("get_stats"), &MPVClipCache::get_stats);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "memory_budget_mb", PROPERTY_HINT_RANGE, "0,16384,1,suffix:MiB"), "set_memory_budget_mb", "get_memory_budget_mb");
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace godot;
+
+#ifdef MPV_HAVE_ZSTD
+struct ZSTD_DCtx_s;
+#endif
+
+// One fully decoded pass of a short clip, as uploaded by MPVPlayer.
+struct MPVCachedClip {
+	struct Frame {
+		PackedByteArray pixels; // RGBA8, or compressed when the clip is
+		double start = 0.0; // seconds from the start of the clip
+	};
+
+	std::vector<Frame> frames;
+	int width = 0;
+	int height = 0;
+	double duration = 0.0;
+	bool compressed = false;
+	int64_t frame_size = 0; // uncompressed bytes per frame
+	int64_t bytes = 0;
+	uint64_t last_used = 0;
+
+	int find_frame(double p_time) const;
+};
+
+// Per-player state for reading cached frames into a buffer the player
+// reuses. With zstd available at build time, compressed frames are
+// decompressed in place through a long-lived context; otherwise Godot's
+// PackedByteArray::decompress is used, which allocates a frame each call.
+class MPVClipDecoder {
+public:
+	MPVClipDecoder() = default;
+	~MPVClipDecoder();
+
+	MPVClipDecoder(const MPVClipDecoder &) = delete;
+	MPVClipDecoder &operator=(const MPVClipDecoder &) = delete;
+
+	// Writes frame p_index of p_clip to r_pixels, which must have room for
+	// p_clip.frame_size bytes.
+	bool decode(const MPVCachedClip &p_clip, int p_index, uint8_t *r_pixels);
+
+private:
+#ifdef MPV_HAVE_ZSTD
+	ZSTD_DCtx_s *context = nullptr;
+#endif
+};
+
+// Engine singleton holding decoded clips shared by every MPVPlayer that
+// plays the same file with the same capture settings. Entries are evicted
+// least recently used first once the memory budget is exceeded, but never
+// while a player is still playing from them.
+class MPVClipCache : public Object {
+	GDCLASS(MPVClipCache, Object)
+
+private:
+	static MPVClipCache *singleton;
+
+	std::map<String, std::shared_ptr<MPVCachedClip>> clips;
+	int64_t memory_budget = 256 * 1024 * 1024;
+	int64_t bytes = 0;
+	uint64_t use_counter = 0;
+
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	uint64_t rejected = 0;
+
+	bool evict(int64_t p_needed);
+
+protected:
+	static void _bind_methods();
+
+public:
+	static MPVClipCache *get_singleton() { return singleton; }
+
+	MPVClipCache();
+	~MPVClipCache() override;
+
+	std::shared_ptr<MPVCachedClip> acquire(const String &p_key);
+	// Returns the clip now cached under p_key, which is an earlier insert
+	// when another player got there first, or null if it did not fit.
+	std::shared_ptr<MPVCachedClip> insert(const String &p_key, const std::shared_ptr<MPVCachedClip> &p_clip);
+
+	void set_memory_budget_mb(double p_megabytes);
+	double get_memory_budget_mb() const { return memory_budget / (1024.0 * 1024.0); }
+	void clear();
+	Dictionary get_stats() const;
+};
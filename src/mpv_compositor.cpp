@@ -0,0 +1,405 @@
+#include "mpv_compositor.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MPV_COMPOSITOR_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MPV_TARGET_AVX2
+#else
+#define MPV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MPV_COMPOSITOR_NEON
+#include <arm_neon.h>
+#endif
+
+// Kernels take the pixel count they can handle in bulk and leave the tail
+// to the scalar loop, so every ISA shares one definition of the maths:
+//
+//   distance = max(|r - kr|, |g - kg|, |b - kb|)
+//   alpha = min(255, (max(0, distance - tolerance) * gain) >> 8)
+//   c[k] -= ((c[k] - max(c[o1], c[o2]))+ * spill) >> 8
+//   c = round(c * alpha / 255)
+
+static inline uint8_t div255(int p_value) {
+	int v = p_value + 128;
+	return (uint8_t)((v + (v >> 8)) >> 8);
+}
+
+static void chroma_key_scalar(uint8_t *p, int64_t p_count, const MPVChromaKey &p_key) {
+	for (int64_t i = 0; i < p_count; i++, p += 4) {
+		int d = std::max({ std::abs(p[0] - p_key.color[0]), std::abs(p[1] - p_key.color[1]), std::abs(p[2] - p_key.color[2]) });
+		int t = std::max(0, d - (int)p_key.tolerance);
+		int a = std::min(255, (t * (int)p_key.gain) >> 8);
+
+		int limit = std::max(p[p_key.other[0]], p[p_key.other[1]]);
+		int over = std::max(0, p[p_key.channel] - limit);
+		p[p_key.channel] = (uint8_t)(p[p_key.channel] - ((over * p_key.spill) >> 8));
+
+		p[0] = div255(p[0] * a);
+		p[1] = div255(p[1] * a);
+		p[2] = div255(p[2] * a);
+		p[3] = (uint8_t)a;
+	}
+}
+
+static void packed_alpha_row_scalar(uint8_t *p_dst, const uint8_t *p_color, const uint8_t *p_matte, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++, p_dst += 4, p_color += 4, p_matte += 4) {
+		int a = (p_matte[0] + 2 * p_matte[1] + p_matte[2]) >> 2;
+		p_dst[0] = div255(p_color[0] * a);
+		p_dst[1] = div255(p_color[1] * a);
+		p_dst[2] = div255(p_color[2] * a);
+		p_dst[3] = (uint8_t)a;
+	}
+}
+
+#ifdef MPV_COMPOSITOR_X86
+
+// SSE2 and AVX2 work on interleaved pixels in 32-bit lanes: per-pixel values
+// live in the low byte of a lane and move between channels with shifts.
+
+static inline __m128i premultiply_sse2(__m128i p_px, __m128i p_alpha) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	__m128i a = _mm_or_si128(p_alpha, _mm_slli_epi32(p_alpha, 8));
+	a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+	__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p_px, zero), _mm_unpacklo_epi8(a, zero)), bias);
+	__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p_px, zero), _mm_unpackhi_epi8(a, zero)), bias);
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+	__m128i rgb = _mm_and_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32(0x00ffffff));
+	return _mm_or_si128(rgb, _mm_slli_epi32(p_alpha, 24));
+}
+
+static inline __m128i shift_channel_sse2(__m128i p_px, int p_from, int p_to) {
+	return p_from > p_to ? _mm_srl_epi32(p_px, _mm_cvtsi32_si128((p_from - p_to) * 8))
+						 : _mm_sll_epi32(p_px, _mm_cvtsi32_si128((p_to - p_from) * 8));
+}
+
+static int64_t chroma_key_sse2(uint8_t *p, int64_t p_count, const MPVChromaKey &p_key) {
+	const __m128i byte_mask = _mm_set1_epi32(0xff);
+	const __m128i key = _mm_set1_epi32(p_key.color[0] | (p_key.color[1] << 8) | (p_key.color[2] << 16));
+	const __m128i tolerance = _mm_set1_epi32(p_key.tolerance);
+	const __m128i gain = _mm_set1_epi32(p_key.gain);
+	const __m128i spill = _mm_set1_epi32(p_key.spill);
+	const __m128i channel_shift = _mm_cvtsi32_si128(p_key.channel * 8);
+	const __m128i zero = _mm_setzero_si128();
+
+	int64_t n = p_count & ~(int64_t)3;
+	for (int64_t i = 0; i < n; i += 4, p += 16) {
+		__m128i px = _mm_loadu_si128((const __m128i *)p);
+
+		__m128i diff = _mm_or_si128(_mm_subs_epu8(px, key), _mm_subs_epu8(key, px));
+		__m128i d = _mm_max_epu8(_mm_max_epu8(diff, _mm_srli_epi32(diff, 8)), _mm_srli_epi32(diff, 16));
+		__m128i t = _mm_subs_epu16(_mm_and_si128(d, byte_mask), tolerance);
+		__m128i lo = _mm_mullo_epi16(t, gain);
+		__m128i hi = _mm_mulhi_epu16(t, gain);
+		__m128i fits = _mm_cmpeq_epi16(hi, zero);
+		__m128i a = _mm_or_si128(_mm_and_si128(fits, _mm_srli_epi16(lo, 8)), _mm_andnot_si128(fits, byte_mask));
+
+		__m128i limit = _mm_max_epu8(shift_channel_sse2(px, p_key.other[0], p_key.channel), shift_channel_sse2(px, p_key.other[1], p_key.channel));
+		__m128i over = _mm_and_si128(_mm_srl_epi32(_mm_subs_epu8(px, limit), channel_shift), byte_mask);
+		__m128i reduce = _mm_srli_epi16(_mm_mullo_epi16(over, spill), 8);
+		px = _mm_sub_epi8(px, _mm_sll_epi32(reduce, channel_shift));
+
+		_mm_storeu_si128((__m128i *)p, premultiply_sse2(px, a));
+	}
+	return n;
+}
+
+static int64_t packed_alpha_row_sse2(uint8_t *p_dst, const uint8_t *p_color, const uint8_t *p_matte, int64_t p_count) {
+	const __m128i byte_mask = _mm_set1_epi32(0xff);
+
+	int64_t n = p_count & ~(int64_t)3;
+	for (int64_t i = 0; i < n; i += 4) {
+		__m128i px = _mm_loadu_si128((const __m128i *)(p_color + i * 4));
+		__m128i m = _mm_loadu_si128((const __m128i *)(p_matte + i * 4));
+
+		__m128i g = _mm_and_si128(_mm_srli_epi32(m, 8), byte_mask);
+		__m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(m, byte_mask), _mm_and_si128(_mm_srli_epi32(m, 16), byte_mask)), _mm_add_epi32(g, g));
+		__m128i a = _mm_srli_epi32(sum, 2);
+
+		_mm_storeu_si128((__m128i *)(p_dst + i * 4), premultiply_sse2(px, a));
+	}
+	return n;
+}
+
+// The AVX2 kernels are the SSE2 ones at twice the width. Unpack, pack and
+// the 16-bit shifts all stay within 128-bit halves, so the lane layout is
+// the same.
+
+MPV_TARGET_AVX2 static inline __m256i premultiply_avx2(__m256i p_px, __m256i p_alpha) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i bias = _mm256_set1_epi16(128);
+	__m256i a = _mm256_or_si256(p_alpha, _mm256_slli_epi32(p_alpha, 8));
+	a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+
+	__m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(p_px, zero), _mm256_unpacklo_epi8(a, zero)), bias);
+	__m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(p_px, zero), _mm256_unpackhi_epi8(a, zero)), bias);
+	lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+	hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+
+	__m256i rgb = _mm256_and_si256(_mm256_packus_epi16(lo, hi), _mm256_set1_epi32(0x00ffffff));
+	return _mm256_or_si256(rgb, _mm256_slli_epi32(p_alpha, 24));
+}
+
+MPV_TARGET_AVX2 static inline __m256i shift_channel_avx2(__m256i p_px, int p_from, int p_to) {
+	return p_from > p_to ? _mm256_srl_epi32(p_px, _mm_cvtsi32_si128((p_from - p_to) * 8))
+						 : _mm256_sll_epi32(p_px, _mm_cvtsi32_si128((p_to - p_from) * 8));
+}
+
+MPV_TARGET_AVX2 static int64_t chroma_key_avx2(uint8_t *p, int64_t p_count, const MPVChromaKey &p_key) {
+	const __m256i byte_mask = _mm256_set1_epi32(0xff);
+	const __m256i key = _mm256_set1_epi32(p_key.color[0] | (p_key.color[1] << 8) | (p_key.color[2] << 16));
+	const __m256i tolerance = _mm256_set1_epi32(p_key.tolerance);
+	const __m256i gain = _mm256_set1_epi32(p_key.gain);
+	const __m256i spill = _mm256_set1_epi32(p_key.spill);
+	const __m128i channel_shift = _mm_cvtsi32_si128(p_key.channel * 8);
+	const __m256i zero = _mm256_setzero_si256();
+
+	int64_t n = p_count & ~(int64_t)7;
+	for (int64_t i = 0; i < n; i += 8, p += 32) {
+		__m256i px = _mm256_loadu_si256((const __m256i *)p);
+
+		__m256i diff = _mm256_or_si256(_mm256_subs_epu8(px, key), _mm256_subs_epu8(key, px));
+		__m256i d = _mm256_max_epu8(_mm256_max_epu8(diff, _mm256_srli_epi32(diff, 8)), _mm256_srli_epi32(diff, 16));
+		__m256i t = _mm256_subs_epu16(_mm256_and_si256(d, byte_mask), tolerance);
+		__m256i lo = _mm256_mullo_epi16(t, gain);
+		__m256i hi = _mm256_mulhi_epu16(t, gain);
+		__m256i fits = _mm256_cmpeq_epi16(hi, zero);
+		__m256i a = _mm256_or_si256(_mm256_and_si256(fits, _mm256_srli_epi16(lo, 8)), _mm256_andnot_si256(fits, byte_mask));
+
+		__m256i limit = _mm256_max_epu8(shift_channel_avx2(px, p_key.other[0], p_key.channel), shift_channel_avx2(px, p_key.other[1], p_key.channel));
+		__m256i over = _mm256_and_si256(_mm256_srl_epi32(_mm256_subs_epu8(px, limit), channel_shift), byte_mask);
+		__m256i reduce = _mm256_srli_epi16(_mm256_mullo_epi16(over, spill), 8);
+		px = _mm256_sub_epi8(px, _mm256_sll_epi32(reduce, channel_shift));
+
+		_mm256_storeu_si256((__m256i *)p, premultiply_avx2(px, a));
+	}
+	return n;
+}
+
+MPV_TARGET_AVX2 static int64_t packed_alpha_row_avx2(uint8_t *p_dst, const uint8_t *p_color, const uint8_t *p_matte, int64_t p_count) {
+	const __m256i byte_mask = _mm256_set1_epi32(0xff);
+
+	int64_t n = p_count & ~(int64_t)7;
+	for (int64_t i = 0; i < n; i += 8) {
+		__m256i px = _mm256_loadu_si256((const __m256i *)(p_color + i * 4));
+		__m256i m = _mm256_loadu_si256((const __m256i *)(p_matte + i * 4));
+
+		__m256i g = _mm256_and_si256(_mm256_srli_epi32(m, 8), byte_mask);
+		__m256i sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_and_si256(m, byte_mask), _mm256_and_si256(_mm256_srli_epi32(m, 16), byte_mask)), _mm256_add_epi32(g, g));
+		__m256i a = _mm256_srli_epi32(sum, 2);
+
+		_mm256_storeu_si256((__m256i *)(p_dst + i * 4), premultiply_avx2(px, a));
+	}
+	return n;
+}
+
+static bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+	__cpuidex(info, 7, 0);
+	return os_saves_ymm && (info[1] & (1 << 5));
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // MPV_COMPOSITOR_X86
+
+#ifdef MPV_COMPOSITOR_NEON
+
+// NEON deinterleaves on load, so these work on whole channels, 16 pixels
+// at a time.
+
+static inline uint8x16_t premultiply_neon(uint8x16_t p_c, uint8x16_t p_a) {
+	const uint16x8_t bias = vdupq_n_u16(128);
+	uint16x8_t lo = vaddq_u16(vmull_u8(vget_low_u8(p_c), vget_low_u8(p_a)), bias);
+	uint16x8_t hi = vaddq_u16(vmull_u8(vget_high_u8(p_c), vget_high_u8(p_a)), bias);
+	return vcombine_u8(vshrn_n_u16(vaddq_u16(lo, vshrq_n_u16(lo, 8)), 8), vshrn_n_u16(vaddq_u16(hi, vshrq_n_u16(hi, 8)), 8));
+}
+
+static inline uint8x8_t ramp_neon(uint8x8_t p_t, uint16x4_t p_gain) {
+	uint16x8_t t = vmovl_u8(p_t);
+	uint32x4_t lo = vshrq_n_u32(vmull_u16(vget_low_u16(t), p_gain), 8);
+	uint32x4_t hi = vshrq_n_u32(vmull_u16(vget_high_u16(t), p_gain), 8);
+	return vqmovn_u16(vcombine_u16(vqmovn_u32(lo), vqmovn_u32(hi)));
+}
+
+static int64_t chroma_key_neon(uint8_t *p, int64_t p_count, const MPVChromaKey &p_key) {
+	const uint8x16_t kr = vdupq_n_u8(p_key.color[0]);
+	const uint8x16_t kg = vdupq_n_u8(p_key.color[1]);
+	const uint8x16_t kb = vdupq_n_u8(p_key.color[2]);
+	const uint8x16_t tolerance = vdupq_n_u8((uint8_t)std::min<int>(p_key.tolerance, 255));
+	const uint16x4_t gain = vdup_n_u16(p_key.gain);
+	const uint16x8_t spill = vdupq_n_u16(p_key.spill);
+
+	int64_t n = p_count & ~(int64_t)15;
+	for (int64_t i = 0; i < n; i += 16, p += 64) {
+		uint8x16x4_t px = vld4q_u8(p);
+
+		uint8x16_t d = vmaxq_u8(vmaxq_u8(vabdq_u8(px.val[0], kr), vabdq_u8(px.val[1], kg)), vabdq_u8(px.val[2], kb));
+		uint8x16_t t = vqsubq_u8(d, tolerance);
+		uint8x16_t a = vcombine_u8(ramp_neon(vget_low_u8(t), gain), ramp_neon(vget_high_u8(t), gain));
+
+		uint8x16_t c = px.val[p_key.channel];
+		uint8x16_t over = vqsubq_u8(c, vmaxq_u8(px.val[p_key.other[0]], px.val[p_key.other[1]]));
+		uint8x16_t reduce = vcombine_u8(vshrn_n_u16(vmulq_u16(vmovl_u8(vget_low_u8(over)), spill), 8),
+				vshrn_n_u16(vmulq_u16(vmovl_u8(vget_high_u8(over)), spill), 8));
+		px.val[p_key.channel] = vsubq_u8(c, reduce);
+
+		px.val[0] = premultiply_neon(px.val[0], a);
+		px.val[1] = premultiply_neon(px.val[1], a);
+		px.val[2] = premultiply_neon(px.val[2], a);
+		px.val[3] = a;
+		vst4q_u8(p, px);
+	}
+	return n;
+}
+
+static int64_t packed_alpha_row_neon(uint8_t *p_dst, const uint8_t *p_color, const uint8_t *p_matte, int64_t p_count) {
+	int64_t n = p_count & ~(int64_t)15;
+	for (int64_t i = 0; i < n; i += 16) {
+		uint8x16x4_t px = vld4q_u8(p_color + i * 4);
+		uint8x16x4_t m = vld4q_u8(p_matte + i * 4);
+
+		uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(m.val[0]), vget_low_u8(m.val[2])), vshll_n_u8(vget_low_u8(m.val[1]), 1));
+		uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(m.val[0]), vget_high_u8(m.val[2])), vshll_n_u8(vget_high_u8(m.val[1]), 1));
+		uint8x16_t a = vcombine_u8(vshrn_n_u16(lo, 2), vshrn_n_u16(hi, 2));
+
+		px.val[0] = premultiply_neon(px.val[0], a);
+		px.val[1] = premultiply_neon(px.val[1], a);
+		px.val[2] = premultiply_neon(px.val[2], a);
+		px.val[3] = a;
+		vst4q_u8(p_dst + i * 4, px);
+	}
+	return n;
+}
+
+#endif // MPV_COMPOSITOR_NEON
+
+bool MPVCompositor::is_isa_supported(Isa p_isa) {
+	switch (p_isa) {
+		case ISA_SCALAR:
+			return true;
+#ifdef MPV_COMPOSITOR_X86
+		case ISA_SSE2:
+			return true;
+		case ISA_AVX2: {
+			static const bool avx2 = cpu_has_avx2();
+			return avx2;
+		}
+#endif
+#ifdef MPV_COMPOSITOR_NEON
+		case ISA_NEON:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+MPVCompositor::Isa MPVCompositor::get_best_isa() {
+	for (int isa = ISA_MAX - 1; isa > ISA_SCALAR; isa--) {
+		if (is_isa_supported((Isa)isa))
+			return (Isa)isa;
+	}
+	return ISA_SCALAR;
+}
+
+const char *MPVCompositor::get_isa_name(Isa p_isa) {
+	static const char *names[ISA_MAX] = { "scalar", "sse2", "avx2", "neon" };
+	return p_isa >= 0 && p_isa < ISA_MAX ? names[p_isa] : "unknown";
+}
+
+MPVChromaKey MPVCompositor::make_chroma_key(float p_r, float p_g, float p_b, float p_tolerance, float p_softness, float p_spill) {
+	MPVChromaKey key;
+	float rgb[3] = { p_r, p_g, p_b };
+	key.channel = 0;
+	for (int i = 0; i < 3; i++) {
+		key.color[i] = (uint8_t)std::clamp((int)(rgb[i] * 255.0f + 0.5f), 0, 255);
+		if (key.color[i] > key.color[key.channel]) {
+			key.channel = i;
+		}
+	}
+	key.other[0] = key.channel == 0 ? 1 : 0;
+	key.other[1] = key.channel == 2 ? 1 : 2;
+
+	// Distance is in 0..255; softness is the width of the ramp from
+	// transparent to opaque, at least one step.
+	key.tolerance = (uint16_t)std::clamp((int)(p_tolerance * 255.0f + 0.5f), 0, 255);
+	int softness = std::clamp((int)(p_softness * 255.0f + 0.5f), 1, 255);
+	key.gain = (uint16_t)(255 * 256 / softness);
+	key.spill = (uint16_t)std::clamp((int)(p_spill * 256.0f + 0.5f), 0, 256);
+	return key;
+}
+
+void MPVCompositor::chroma_key(Isa p_isa, uint8_t *p_pixels, int64_t p_count, const MPVChromaKey &p_key) {
+	int64_t done = 0;
+	switch (p_isa) {
+#ifdef MPV_COMPOSITOR_X86
+		case ISA_SSE2:
+			done = chroma_key_sse2(p_pixels, p_count, p_key);
+			break;
+		case ISA_AVX2:
+			done = chroma_key_avx2(p_pixels, p_count, p_key);
+			break;
+#endif
+#ifdef MPV_COMPOSITOR_NEON
+		case ISA_NEON:
+			done = chroma_key_neon(p_pixels, p_count, p_key);
+			break;
+#endif
+		default:
+			break;
+	}
+	chroma_key_scalar(p_pixels + done * 4, p_count - done, p_key);
+}
+
+int MPVCompositor::packed_alpha(Isa p_isa, uint8_t *p_pixels, int p_width, int p_height) {
+	return packed_alpha(p_isa, p_pixels, p_pixels, p_width, p_height);
+}
+
+int MPVCompositor::packed_alpha(Isa p_isa, const uint8_t *p_src, uint8_t *p_dst, int p_width, int p_height) {
+	// Matte is right-aligned so an odd width drops the middle column.
+	// Output row y ends at or before input row y starts for every y > 0,
+	// and row 0 reads each block before writing it, so this is safe in place.
+	int half = p_width / 2;
+	int matte_offset = p_width - half;
+
+	for (int y = 0; y < p_height; y++) {
+		uint8_t *dst = p_dst + (int64_t)y * half * 4;
+		const uint8_t *color = p_src + (int64_t)y * p_width * 4;
+		const uint8_t *matte = color + (int64_t)matte_offset * 4;
+
+		int64_t done = 0;
+		switch (p_isa) {
+#ifdef MPV_COMPOSITOR_X86
+			case ISA_SSE2:
+				done = packed_alpha_row_sse2(dst, color, matte, half);
+				break;
+			case ISA_AVX2:
+				done = packed_alpha_row_avx2(dst, color, matte, half);
+				break;
+#endif
+#ifdef MPV_COMPOSITOR_NEON
+			case ISA_NEON:
+				done = packed_alpha_row_neon(dst, color, matte, half);
+				break;
+#endif
+			default:
+				break;
+		}
+		packed_alpha_row_scalar(dst + done * 4, color + done * 4, matte + done * 4, half - done);
+	}
+	return half;
+}
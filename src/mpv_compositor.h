@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// Chroma key parameters in the compositor's integer form; see
+// MPVCompositor::make_chroma_key().
+struct MPVChromaKey {
+	uint8_t color[3];
+	uint16_t tolerance; // colour distance below which a pixel is fully keyed
+	uint16_t gain; // alpha ramp above the tolerance, 8.8 fixed point
+	uint16_t spill; // 0..256, how much of the key colour's excess to remove
+	int channel; // strongest channel of the key colour, the one that spills
+	int other[2];
+};
+
+// Post-render pixel kernels for transparent video. They work in place on
+// tightly packed RGBA8 frames and write premultiplied alpha. Each kernel
+// has a scalar version and SSE2/AVX2 or NEON versions that give identical
+// results; the best one the CPU supports is picked at runtime.
+class MPVCompositor {
+public:
+	enum Isa {
+		ISA_SCALAR,
+		ISA_SSE2,
+		ISA_AVX2,
+		ISA_NEON,
+		ISA_MAX,
+	};
+
+	static Isa get_best_isa();
+	static bool is_isa_supported(Isa p_isa);
+	static const char *get_isa_name(Isa p_isa);
+
+	// p_tolerance, p_softness and p_spill are 0..1.
+	static MPVChromaKey make_chroma_key(float p_r, float p_g, float p_b, float p_tolerance, float p_softness, float p_spill);
+
+	// Alpha from the distance to the key colour, key spill removed from
+	// the colour channels.
+	static void chroma_key(Isa p_isa, uint8_t *p_pixels, int64_t p_count, const MPVChromaKey &p_key);
+
+	// Side-by-side packed alpha: colour in the left half, alpha matte in
+	// the right half. Rows are compacted to the front of the buffer, which
+	// then holds a p_width / 2 wide frame. Returns the new width.
+	static int packed_alpha(Isa p_isa, uint8_t *p_pixels, int p_width, int p_height);
+	// Same, but writes the compacted frame to p_dst, which must not overlap
+	// p_src unless it is p_src.
+	static int packed_alpha(Isa p_isa, const uint8_t *p_src, uint8_t *p_dst, int p_width, int p_height);
+};
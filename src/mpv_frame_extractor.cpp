@@ -0,0 +1,361 @@
+#include "mpv_frame_extractor.h"
+
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+static int64_t extractor_now_usec() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MPVFrameExtractor::MPVFrameExtractor() {
+	set_process(false);
+}
+
+MPVFrameExtractor::~MPVFrameExtractor() {
+	cancel();
+}
+
+void MPVFrameExtractor::start(const String &p_path) {
+	cancel();
+
+	// Setters only affect the next run
+	job_output_size = output_size;
+	job_frame_step = frame_step;
+	job_start_time = start_time;
+	job_end_time = end_time;
+
+	// One slot more than queue_size, held back for the frame that may
+	// already be on its way to the VO when the worker pauses mpv.
+	pool.assign(queue_size + 1, PackedByteArray());
+	free_slots.clear();
+	for (int i = queue_size; i >= 0; i--) {
+		free_slots.push_back(i);
+	}
+	ready_frames.clear();
+
+	frames.clear();
+	frame_times.clear();
+	frame_width.store(0);
+	frame_height.store(0);
+	frames_decoded.store(0);
+	queue_stalls.store(0);
+	frames_dropped.store(0);
+	worker_error.clear();
+	frames_delivered = 0;
+	start_usec = extractor_now_usec();
+	end_usec = 0;
+
+	String mpv_path = p_path;
+	if (p_path.begins_with("res://") || p_path.begins_with("user://")) {
+		mpv_path = ProjectSettings::get_singleton()->globalize_path(p_path);
+	}
+
+	worker_finished.store(false);
+	headless.reset_abort();
+	running = true;
+	set_process(true);
+
+	worker = std::thread(&MPVFrameExtractor::run_worker, this, mpv_path.utf8());
+}
+
+void MPVFrameExtractor::cancel() {
+	if (worker.joinable()) {
+		headless.abort();
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			slot_freed.notify_all();
+		}
+		worker.join();
+	}
+
+	ready_frames.clear();
+	running = false;
+	set_process(false);
+}
+
+void MPVFrameExtractor::clear_frames() {
+	frames.clear();
+	frame_times.clear();
+}
+
+int MPVFrameExtractor::acquire_slot() {
+	std::unique_lock<std::mutex> lock(queue_mutex);
+	// Only reached if mpv handed over more frames after the pause than the
+	// reserve slot covers; waiting here risks a VO drop, which shows up in
+	// frames_dropped.
+	slot_freed.wait(lock, [this] { return !free_slots.empty() || headless.is_aborted(); });
+	if (headless.is_aborted())
+		return -1;
+
+	int slot = free_slots.back();
+	free_slots.pop_back();
+	return slot;
+}
+
+size_t MPVFrameExtractor::get_free_slot_count() {
+	std::lock_guard<std::mutex> lock(queue_mutex);
+	return free_slots.size();
+}
+
+void MPVFrameExtractor::run_worker(CharString p_path) {
+	char start_str[32];
+	char end_str[32];
+	snprintf(start_str, sizeof(start_str), "%.3f", job_start_time);
+	snprintf(end_str, sizeof(end_str), "%.3f", job_end_time);
+
+	// untimed + framedrop=no makes the VO take every frame as soon as it is
+	// decoded; the render call below is the only thing pacing playback.
+	std::vector<MPVHeadless::Option> options = {
+		{ "vo", "libmpv" },
+		{ "untimed", "yes" },
+		{ "framedrop", "no" },
+		{ "aid", "no" },
+		{ "ao", "null" },
+		{ "sid", "no" },
+		{ "hwdec", "no" },
+		{ "hr-seek", "yes" },
+		{ "keep-open", "no" },
+		{ "terminal", "no" },
+		{ "osd-level", "0" },
+		{ "start", start_str },
+	};
+	if (job_end_time > job_start_time) {
+		options.push_back({ "end", end_str });
+	}
+
+	if (!headless.create(options.data(), (int)options.size(), true) ||
+			!headless.load_file(p_path.get_data(), 15000)) {
+		headless.destroy();
+		end_usec = extractor_now_usec();
+		worker_finished.store(true);
+		return;
+	}
+
+	mpv_handle *mpv = headless.get_handle();
+	int width = 0;
+	int height = 0;
+	int64_t decoded = 0;
+
+	// Frames skipped by frame_step still have to be consumed to advance the
+	// VO; render those at a token size so they cost almost nothing.
+	uint8_t discard[16 * 16 * 4];
+
+	// vo_libmpv drops a frame that is not rendered within about 200 ms, so
+	// the worker must never block while mpv has one waiting. Instead it
+	// pauses mpv once only the reserve slot is left, keeps polling for a
+	// frame that was already in flight, and resumes when the main thread
+	// has handed a slot back.
+	bool paused = false;
+
+	while (!headless.is_aborted()) {
+		if (paused && get_free_slot_count() > 1) {
+			mpv_set_property_string(mpv, "pause", "no");
+			paused = false;
+		}
+
+		if (!headless.wait_for_frame(paused ? 20 : 10000)) {
+			if (paused && !headless.is_eof())
+				continue;
+			break;
+		}
+
+		// Pausing and resuming can request a redraw of the frame already
+		// delivered; consume it without counting it.
+		if (headless.is_redraw()) {
+			headless.render(16, 16, 16 * 4, discard);
+			continue;
+		}
+
+		if (width <= 0 || height <= 0) {
+			int64_t w = 0;
+			int64_t h = 0;
+			mpv_get_property(mpv, "width", MPV_FORMAT_INT64, &w);
+			mpv_get_property(mpv, "height", MPV_FORMAT_INT64, &h);
+			if (w <= 0 || h <= 0) {
+				worker_error = "Video dimensions not available for extraction";
+				break;
+			}
+
+			width = job_output_size.x > 0 ? job_output_size.x : (job_output_size.y > 0 ? (int)(w * job_output_size.y / h) : (int)w);
+			height = job_output_size.y > 0 ? job_output_size.y : (int)(h * width / w);
+			frame_width.store(width);
+			frame_height.store(height);
+		}
+
+		int64_t index = decoded++;
+		frames_decoded.store(decoded);
+
+		if (index % job_frame_step != 0) {
+			headless.render(16, 16, 16 * 4, discard);
+			continue;
+		}
+
+		int slot = acquire_slot();
+		if (slot < 0)
+			break;
+
+		PackedByteArray &buffer = pool[slot];
+		if (buffer.size() != width * height * 4) {
+			buffer.resize(width * height * 4);
+		}
+
+		bool rendered = headless.render(width, height, width * 4, buffer.ptrw());
+
+		double pts = 0.0;
+		mpv_get_property(mpv, "time-pos", MPV_FORMAT_DOUBLE, &pts);
+		int64_t dropped = 0;
+		if (mpv_get_property(mpv, "frame-drop-count", MPV_FORMAT_INT64, &dropped) >= 0) {
+			frames_dropped.store(dropped);
+		}
+
+		bool reserve_only;
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			if (rendered) {
+				ready_frames.push_back({ (int)index, pts, slot });
+			} else {
+				free_slots.push_back(slot);
+			}
+			reserve_only = free_slots.size() <= 1;
+		}
+
+		if (reserve_only && !paused) {
+			queue_stalls.fetch_add(1);
+			mpv_set_property_string(mpv, "pause", "yes");
+			paused = true;
+		}
+	}
+
+	headless.destroy();
+	end_usec = extractor_now_usec();
+	worker_finished.store(true);
+}
+
+void MPVFrameExtractor::deliver_frames() {
+	while (true) {
+		Frame frame;
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			if (ready_frames.empty())
+				break;
+			frame = ready_frames.front();
+			ready_frames.pop_front();
+		}
+
+		// The signal argument shares the pool buffer; if a listener keeps it,
+		// the worker's next write to this slot copies instead of clobbering.
+		PackedByteArray pixels = pool[frame.slot];
+		emit_signal("frame_extracted", frame.index, frame.pts, pixels);
+		if (collect_frames) {
+			frames.append(pixels);
+			frame_times.append(frame.pts);
+		}
+		frames_delivered++;
+		pixels = PackedByteArray();
+
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		free_slots.push_back(frame.slot);
+		slot_freed.notify_one();
+	}
+}
+
+void MPVFrameExtractor::_notification(int p_what) {
+	if (p_what != NOTIFICATION_PROCESS || !running)
+		return;
+
+	bool finished = worker_finished.load();
+	deliver_frames();
+
+	if (finished) {
+		worker.join();
+		deliver_frames();
+		running = false;
+		set_process(false);
+
+		// Logged here rather than on the worker thread that hit them
+		for (const std::string &warning : headless.get_warnings()) {
+			UtilityFunctions::push_warning(vformat("MPV: %s", String::utf8(warning.c_str())));
+		}
+		if (!headless.get_error().empty()) {
+			UtilityFunctions::push_error(vformat("MPV: %s", String::utf8(headless.get_error().c_str())));
+		}
+		if (!worker_error.empty()) {
+			UtilityFunctions::push_error(vformat("MPV: %s", String::utf8(worker_error.c_str())));
+		}
+
+		double fps = get_frames_per_second();
+		if (frames_dropped.load() > 0) {
+			UtilityFunctions::push_warning(vformat("MPV: %d frames were dropped during extraction; frame indices no longer match the source", frames_dropped.load()));
+		}
+		UtilityFunctions::print(vformat("MPV: Extracted %d frames (%d decoded) at %.1f fps", frames_delivered, frames_decoded.load(), fps));
+		emit_signal("extraction_finished", frames_delivered, fps);
+	}
+}
+
+double MPVFrameExtractor::get_frames_per_second() const {
+	int64_t end = running ? extractor_now_usec() : end_usec;
+	int64_t elapsed = end - start_usec;
+	if (elapsed <= 0)
+		return 0.0;
+	return double(frames_decoded.load()) * 1000000.0 / double(elapsed);
+}
+
+Dictionary MPVFrameExtractor::get_stats() const {
+	Dictionary stats;
+	int64_t end = running ? extractor_now_usec() : end_usec;
+	stats["frames_decoded"] = frames_decoded.load();
+	stats["frames_delivered"] = frames_delivered;
+	stats["queue_stalls"] = queue_stalls.load();
+	stats["frames_dropped"] = frames_dropped.load();
+	stats["elapsed"] = double(end - start_usec) / 1000000.0;
+	stats["fps"] = get_frames_per_second();
+	return stats;
+}
+
+void MPVFrameExtractor::set_frame_step(int p_step) {
+	frame_step = MAX(1, p_step);
+}
+
+void MPVFrameExtractor::set_queue_size(int p_size) {
+	queue_size = CLAMP(p_size, 1, 256);
+}
+
+void MPVFrameExtractor::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start", "path"), &MPVFrameExtractor::start);
+	ClassDB::bind_method(D_METHOD("cancel"), &MPVFrameExtractor::cancel);
+	ClassDB::bind_method(D_METHOD("is_running"), &MPVFrameExtractor::is_running);
+
+	ClassDB::bind_method(D_METHOD("get_frames"), &MPVFrameExtractor::get_frames);
+	ClassDB::bind_method(D_METHOD("get_frame_times"), &MPVFrameExtractor::get_frame_times);
+	ClassDB::bind_method(D_METHOD("clear_frames"), &MPVFrameExtractor::clear_frames);
+	ClassDB::bind_method(D_METHOD("get_frame_size"), &MPVFrameExtractor::get_frame_size);
+	ClassDB::bind_method(D_METHOD("get_frames_per_second"), &MPVFrameExtractor::get_frames_per_second);
+	ClassDB::bind_method(D_METHOD("get_stats"), &MPVFrameExtractor::get_stats);
+
+	ClassDB::bind_method(D_METHOD("set_output_size", "size"), &MPVFrameExtractor::set_output_size);
+	ClassDB::bind_method(D_METHOD("get_output_size"), &MPVFrameExtractor::get_output_size);
+	ClassDB::bind_method(D_METHOD("set_frame_step", "step"), &MPVFrameExtractor::set_frame_step);
+	ClassDB::bind_method(D_METHOD("get_frame_step"), &MPVFrameExtractor::get_frame_step);
+	ClassDB::bind_method(D_METHOD("set_start_time", "time"), &MPVFrameExtractor::set_start_time);
+	ClassDB::bind_method(D_METHOD("get_start_time"), &MPVFrameExtractor::get_start_time);
+	ClassDB::bind_method(D_METHOD("set_end_time", "time"), &MPVFrameExtractor::set_end_time);
+	ClassDB::bind_method(D_METHOD("get_end_time"), &MPVFrameExtractor::get_end_time);
+	ClassDB::bind_method(D_METHOD("set_queue_size", "size"), &MPVFrameExtractor::set_queue_size);
+	ClassDB::bind_method(D_METHOD("get_queue_size"), &MPVFrameExtractor::get_queue_size);
+	ClassDB::bind_method(D_METHOD("set_collect_frames", "collect"), &MPVFrameExtractor::set_collect_frames);
+	ClassDB::bind_method(D_METHOD("get_collect_frames"), &MPVFrameExtractor::get_collect_frames);
+
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2I, "output_size"), "set_output_size", "get_output_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_step", PROPERTY_HINT_RANGE, "1,1000"), "set_frame_step", "get_frame_step");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "start_time", PROPERTY_HINT_NONE, "suffix:s"), "set_start_time", "get_start_time");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "end_time", PROPERTY_HINT_NONE, "suffix:s"), "set_end_time", "get_end_time");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "queue_size", PROPERTY_HINT_RANGE, "1,256"), "set_queue_size", "get_queue_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "collect_frames"), "set_collect_frames", "get_collect_frames");
+
+	ADD_SIGNAL(MethodInfo("frame_extracted", PropertyInfo(Variant::INT, "index"), PropertyInfo(Variant::FLOAT, "pts"), PropertyInfo(Variant::PACKED_BYTE_ARRAY, "pixels")));
+	ADD_SIGNAL(MethodInfo("extraction_finished", PropertyInfo(Variant::INT, "frame_count"), PropertyInfo(Variant::FLOAT, "fps")));
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "mpv_headless.h"
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_float64_array.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace godot;
+
+// Decodes a file as fast as the CPU allows (mpv "untimed", no audio output)
+// and hands every frame to the main thread together with its PTS. The
+// worker renders into a fixed pool of buffers and pauses mpv when all of
+// them are waiting to be consumed, so memory stays bounded and no frame is
+// dropped while the main thread catches up.
+class MPVFrameExtractor : public Node {
+	GDCLASS(MPVFrameExtractor, Node)
+
+private:
+	struct Frame {
+		int index;
+		double pts;
+		int slot;
+	};
+
+	Vector2i output_size;
+	int frame_step = 1;
+	double start_time = 0.0;
+	double end_time = -1.0;
+	int queue_size = 8;
+	bool collect_frames = false;
+
+	// Settings of the run in flight, snapshotted by start() so the worker
+	// never reads a value a setter is changing.
+	Vector2i job_output_size;
+	int job_frame_step = 1;
+	double job_start_time = 0.0;
+	double job_end_time = -1.0;
+
+	std::thread worker;
+	MPVHeadless headless;
+
+	std::mutex queue_mutex;
+	std::condition_variable slot_freed;
+	std::vector<PackedByteArray> pool;
+	std::vector<int> free_slots;
+	std::deque<Frame> ready_frames;
+
+	std::atomic<bool> worker_finished{ false };
+	std::atomic<int> frame_width{ 0 };
+	std::atomic<int> frame_height{ 0 };
+	std::atomic<int64_t> frames_decoded{ 0 };
+	std::atomic<int64_t> queue_stalls{ 0 };
+	std::atomic<int64_t> frames_dropped{ 0 };
+	std::string worker_error; // read once the worker has finished
+	bool running = false;
+
+	int64_t frames_delivered = 0;
+	int64_t start_usec = 0;
+	int64_t end_usec = 0;
+
+	Array frames;
+	PackedFloat64Array frame_times;
+
+	void run_worker(CharString p_path);
+	int acquire_slot();
+	size_t get_free_slot_count();
+	void deliver_frames();
+
+protected:
+	static void _bind_methods();
+	void _notification(int p_what);
+
+public:
+	MPVFrameExtractor();
+	~MPVFrameExtractor() override;
+
+	void start(const String &p_path);
+	void cancel();
+	bool is_running() const { return running; }
+
+	Array get_frames() const { return frames; }
+	PackedFloat64Array get_frame_times() const { return frame_times; }
+	void clear_frames();
+	Vector2i get_frame_size() const { return Vector2i(frame_width.load(), frame_height.load()); }
+
+	double get_frames_per_second() const;
+	Dictionary get_stats() const;
+
+	void set_output_size(const Vector2i &p_size) { output_size = p_size; }
+	Vector2i get_output_size() const { return output_size; }
+	void set_frame_step(int p_step);
+	int get_frame_step() const { return frame_step; }
+	void set_start_time(double p_time) { start_time = p_time; }
+	double get_start_time() const { return start_time; }
+	void set_end_time(double p_time) { end_time = p_time; }
+	double get_end_time() const { return end_time; }
+	void set_queue_size(int p_size);
+	int get_queue_size() const { return queue_size; }
+	void set_collect_frames(bool p_collect) { collect_frames = p_collect; }
+	bool get_collect_frames() const { return collect_frames; }
+};
@@ -0,0 +1,256 @@
+#include "mpv_headless.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+MPVHeadless::~MPVHeadless() {
+	destroy();
+}
+
+void MPVHeadless::set_error(const char *p_format, ...) {
+	char buffer[512];
+	va_list args;
+	va_start(args, p_format);
+	vsnprintf(buffer, sizeof(buffer), p_format, args);
+	va_end(args);
+	error_message = buffer;
+}
+
+bool MPVHeadless::create(const Option *p_options, int p_option_count, bool p_render) {
+	destroy();
+	error_message.clear();
+	warnings.clear();
+
+	mpv = mpv_create();
+	if (!mpv) {
+		set_error("Failed to create headless instance");
+		return false;
+	}
+
+	for (int i = 0; i < p_option_count; i++) {
+		if (mpv_set_option_string(mpv, p_options[i].name, p_options[i].value) < 0) {
+			warnings.push_back(std::string("Failed to set ") + p_options[i].name + "=" + p_options[i].value);
+		}
+	}
+
+	int ret = mpv_initialize(mpv);
+	if (ret < 0) {
+		set_error("Failed to initialize headless instance: %s", mpv_error_string(ret));
+		mpv_terminate_destroy(mpv);
+		mpv = nullptr;
+		return false;
+	}
+
+	mpv_set_wakeup_callback(mpv, on_wakeup, this);
+
+	if (p_render) {
+		mpv_render_param params[] = {
+			{ MPV_RENDER_PARAM_API_TYPE, const_cast<char *>(MPV_RENDER_API_TYPE_SW) },
+			{ MPV_RENDER_PARAM_INVALID, nullptr }
+		};
+
+		ret = mpv_render_context_create(&render_context, mpv, params);
+		if (ret < 0) {
+			set_error("Failed to create headless render context: %s", mpv_error_string(ret));
+			destroy();
+			return false;
+		}
+
+		mpv_render_context_set_update_callback(render_context, on_render_update, this);
+	}
+
+	return true;
+}
+
+void MPVHeadless::destroy() {
+	if (render_context) {
+		mpv_render_context_free(render_context);
+		render_context = nullptr;
+	}
+
+	if (mpv) {
+		mpv_set_wakeup_callback(mpv, nullptr, nullptr);
+		mpv_terminate_destroy(mpv);
+		mpv = nullptr;
+	}
+
+	file_loaded = false;
+	frame_ready = false;
+	eof = false;
+	error = 0;
+	restart_count = 0;
+	render_update.store(false);
+}
+
+void MPVHeadless::abort() {
+	aborted.store(true);
+	std::lock_guard<std::mutex> lock(wake_mutex);
+	woken = true;
+	wake_cond.notify_all();
+}
+
+int64_t MPVHeadless::now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void MPVHeadless::on_wakeup(void *ctx) {
+	MPVHeadless *self = static_cast<MPVHeadless *>(ctx);
+	std::lock_guard<std::mutex> lock(self->wake_mutex);
+	self->woken = true;
+	self->wake_cond.notify_all();
+}
+
+void MPVHeadless::on_render_update(void *ctx) {
+	MPVHeadless *self = static_cast<MPVHeadless *>(ctx);
+	self->render_update.store(true);
+	on_wakeup(ctx);
+}
+
+void MPVHeadless::pump(int64_t p_deadline_us) {
+	while (true) {
+		mpv_event *event = mpv_wait_event(mpv, 0);
+		if (event->event_id == MPV_EVENT_NONE)
+			break;
+
+		switch (event->event_id) {
+			case MPV_EVENT_FILE_LOADED:
+				file_loaded = true;
+				break;
+			case MPV_EVENT_PLAYBACK_RESTART:
+				restart_count++;
+				break;
+			case MPV_EVENT_END_FILE: {
+				mpv_event_end_file *ef = static_cast<mpv_event_end_file *>(event->data);
+				eof = true;
+				if (ef->reason == MPV_END_FILE_REASON_ERROR) {
+					error = ef->error;
+				}
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	if (render_context && render_update.exchange(false)) {
+		if (mpv_render_context_update(render_context) & MPV_RENDER_UPDATE_FRAME) {
+			frame_ready = true;
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(wake_mutex);
+	if (!woken) {
+		int64_t wait_us = p_deadline_us - now_us();
+		if (wait_us > 0) {
+			wake_cond.wait_for(lock, std::chrono::microseconds(wait_us), [this] { return woken; });
+		}
+	}
+	woken = false;
+}
+
+bool MPVHeadless::load_file(const char *p_path, int p_timeout_ms) {
+	if (!mpv)
+		return false;
+
+	file_loaded = false;
+	frame_ready = false;
+	eof = false;
+	error = 0;
+
+	const char *cmd[] = { "loadfile", p_path, nullptr };
+	int ret = mpv_command(mpv, cmd);
+	if (ret < 0) {
+		set_error("Failed to load file: %s", mpv_error_string(ret));
+		return false;
+	}
+
+	int64_t deadline = now_us() + int64_t(p_timeout_ms) * 1000;
+	while (!file_loaded && !eof && !aborted.load()) {
+		if (now_us() >= deadline) {
+			set_error("Timed out loading %s", p_path);
+			return false;
+		}
+		pump(deadline);
+	}
+
+	if (error < 0) {
+		set_error("Playback error: %s", mpv_error_string(error));
+	}
+	return file_loaded && !aborted.load();
+}
+
+bool MPVHeadless::seek(double p_time, bool p_exact, int p_timeout_ms) {
+	if (!mpv)
+		return false;
+
+	char time_str[32];
+	snprintf(time_str, sizeof(time_str), "%.3f", p_time);
+
+	uint64_t restarts = restart_count;
+	frame_ready = false;
+
+	const char *cmd[] = { "seek", time_str, p_exact ? "absolute+exact" : "absolute+keyframes", nullptr };
+	if (mpv_command(mpv, cmd) < 0) {
+		return false;
+	}
+
+	int64_t deadline = now_us() + int64_t(p_timeout_ms) * 1000;
+	while (!(restart_count != restarts && frame_ready) && !aborted.load()) {
+		if (now_us() >= deadline || (eof && error < 0)) {
+			return false;
+		}
+		pump(deadline);
+	}
+	return !aborted.load();
+}
+
+bool MPVHeadless::wait_for_frame(int p_timeout_ms) {
+	if (!render_context)
+		return false;
+
+	int64_t deadline = now_us() + int64_t(p_timeout_ms) * 1000;
+	while (!frame_ready && !aborted.load()) {
+		if (eof || now_us() >= deadline) {
+			return false;
+		}
+		pump(deadline);
+	}
+	return !aborted.load();
+}
+
+bool MPVHeadless::is_redraw() {
+	if (!render_context)
+		return false;
+
+	mpv_render_frame_info info = {};
+	mpv_render_param param = { MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info };
+	if (mpv_render_context_get_info(render_context, param) < 0)
+		return false;
+	return (info.flags & MPV_RENDER_FRAME_INFO_REDRAW) != 0;
+}
+
+bool MPVHeadless::render(int p_width, int p_height, int p_stride, void *p_pixels) {
+	if (!render_context)
+		return false;
+
+	int size[2] = { p_width, p_height };
+	int stride = p_stride;
+	const char *format = "rgba";
+
+	mpv_render_param render_params[] = {
+		{ MPV_RENDER_PARAM_SW_SIZE, size },
+		{ MPV_RENDER_PARAM_SW_FORMAT, const_cast<char *>(format) },
+		{ MPV_RENDER_PARAM_SW_STRIDE, &stride },
+		{ MPV_RENDER_PARAM_SW_POINTER, p_pixels },
+		{ MPV_RENDER_PARAM_INVALID, nullptr }
+	};
+
+	frame_ready = false;
+	int ret = mpv_render_context_render(render_context, render_params);
+	if (ret < 0) {
+		set_error("Render failed: %s", mpv_error_string(ret));
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <mpv/client.h>
+#include <mpv/render.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Off-screen mpv instance driven synchronously from a worker thread.
+// It is not a Godot object. Thumbnail and frame extraction jobs own one
+// each and block on it, so the main thread never waits on mpv. It never
+// logs through Godot either: problems are kept for the owner to report
+// from the main thread once the job is done.
+class MPVHeadless {
+public:
+	struct Option {
+		const char *name;
+		const char *value;
+	};
+
+	MPVHeadless() = default;
+	~MPVHeadless();
+
+	MPVHeadless(const MPVHeadless &) = delete;
+	MPVHeadless &operator=(const MPVHeadless &) = delete;
+
+	// Creates and initialises mpv with the given options. The SW render
+	// context is only created when p_render is set.
+	bool create(const Option *p_options, int p_option_count, bool p_render);
+	void destroy();
+
+	// Thread-safe; makes every pending wait return false. The flag stays set
+	// until reset_abort(), so an abort that lands before the worker gets to
+	// create() is not lost.
+	void abort();
+	// Call on the owning thread when a job is queued, never on the worker.
+	void reset_abort() { aborted.store(false); }
+	bool is_aborted() const { return aborted.load(); }
+
+	// Sends loadfile and waits for MPV_EVENT_FILE_LOADED.
+	bool load_file(const char *p_path, int p_timeout_ms);
+	// Keyframe (or exact) seek that waits for the new frame to be ready.
+	bool seek(double p_time, bool p_exact, int p_timeout_ms);
+	// Waits for the next frame; returns false on EOF, error or timeout.
+	bool wait_for_frame(int p_timeout_ms);
+	// True when the pending frame only repeats the last one (a redraw, e.g.
+	// after pausing) instead of being a newly decoded frame.
+	bool is_redraw();
+	bool render(int p_width, int p_height, int p_stride, void *p_pixels);
+
+	mpv_handle *get_handle() const { return mpv; }
+	bool is_eof() const { return eof; }
+
+	// Why the last failing call failed, empty if nothing did since
+	// create(). Warnings are options mpv rejected and similar; the job
+	// carried on regardless. Read them on the thread that ran the job, or
+	// after joining it.
+	const std::string &get_error() const { return error_message; }
+	const std::vector<std::string> &get_warnings() const { return warnings; }
+
+private:
+	mpv_handle *mpv = nullptr;
+	mpv_render_context *render_context = nullptr;
+
+	std::mutex wake_mutex;
+	std::condition_variable wake_cond;
+	bool woken = false;
+	std::atomic<bool> render_update{ false };
+	std::atomic<bool> aborted{ false };
+
+	bool file_loaded = false;
+	bool frame_ready = false;
+	bool eof = false;
+	int error = 0;
+	uint64_t restart_count = 0;
+
+	std::string error_message;
+	std::vector<std::string> warnings;
+
+	void set_error(const char *p_format, ...);
+	void pump(int64_t p_deadline_us);
+	static int64_t now_us();
+	static void on_wakeup(void *ctx);
+	static void on_render_update(void *ctx);
+};
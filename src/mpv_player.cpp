@@ -1,9 +1,18 @@
 #include "mpv_player.h"
+#include "mpv_alloc_probe.h"
+#include "mpv_render_scheduler.h"
+#include <godot_cpp/classes/display_server.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
+#include <algorithm>
+
 MPVPlayer::MPVPlayer() :
-		target_texture_rect(nullptr),
 		is_buffering(false),
 		texture_needs_update(false) {
 	mpv = nullptr;
@@ -13,12 +22,28 @@ MPVPlayer::MPVPlayer() :
 	video_width = 0;
 	video_height = 0;
 
+	// Signals emitted from the event loop, interned once
+	signal_buffering_started = StringName("buffering_started");
+	signal_buffering_ended = StringName("buffering_ended");
+	signal_subtitle_changed = StringName("subtitle_changed");
+	signal_playback_finished = StringName("playback_finished");
+	signal_file_loaded = StringName("file_loaded");
+	pending_signals.reserve(16);
+
+	// Created up front so consumers can bind to it before the first frame.
+	texture.instantiate();
+	preview_texture.instantiate();
+
+	update_chroma_key();
 
 	set_process(true);
 	initialize_mpv();
 }
 
 MPVPlayer::~MPVPlayer() {
+	if (MPVRenderScheduler::get_singleton()) {
+		MPVRenderScheduler::get_singleton()->unregister_player(this);
+	}
 	cleanup_mpv();
 }
 
@@ -60,6 +85,7 @@ void MPVPlayer::initialize_mpv() {
 	ret = mpv_set_option_string(mpv, "keep-open", "yes");
 
 	mpv_set_option_string(mpv, "profile", "fast");
+	apply_quality_level(quality_level, -1);
 	mpv_set_option_string(mpv, "video-sync", "display");
 
 	mpv_set_option_string(mpv, "network-timeout", "15");
@@ -86,9 +112,16 @@ void MPVPlayer::initialize_mpv() {
 
 	UtilityFunctions::print("MPV: Initialized successfully");
 
+	mpv_observe_property(mpv, 0, "time-pos", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(mpv, 1, "pause", MPV_FORMAT_FLAG);
 	mpv_observe_property(mpv, 2, "paused-for-cache", MPV_FORMAT_FLAG);
 	mpv_observe_property(mpv, 3, "core-idle", MPV_FORMAT_FLAG);
 	mpv_observe_property(mpv, 4, "sub-text", MPV_FORMAT_STRING);
+	mpv_observe_property(mpv, 5, "frame-drop-count", MPV_FORMAT_INT64);
+	mpv_observe_property(mpv, 6, "decoder-frame-drop-count", MPV_FORMAT_INT64);
+	mpv_observe_property(mpv, 7, "speed", MPV_FORMAT_DOUBLE);
+	mpv_observe_property(mpv, 8, "width", MPV_FORMAT_INT64);
+	mpv_observe_property(mpv, 9, "height", MPV_FORMAT_INT64);
 
 	// Request log messages at info level for debugging
 	mpv_request_log_messages(mpv, "info");
@@ -123,6 +156,8 @@ void MPVPlayer::cleanup_mpv() {
 		mpv_terminate_destroy(mpv);
 		mpv = nullptr;
 	}
+	observed_width = 0;
+	observed_height = 0;
 }
 
 void MPVPlayer::on_mpv_render_update(void *ctx) {
@@ -132,211 +167,1481 @@ void MPVPlayer::on_mpv_render_update(void *ctx) {
     }
 }
 
+// Bytes for an RGBA8 frame, plus Godot's mipmap chain when p_mipmaps is set:
+// every level down to 1x1, each side halved with a floor of 1.
+static int frame_data_size(int p_width, int p_height, bool p_mipmaps) {
+	int size = p_width * p_height * 4;
+	while (p_mipmaps && (p_width > 1 || p_height > 1)) {
+		p_width = MAX(1, p_width >> 1);
+		p_height = MAX(1, p_height >> 1);
+		size += p_width * p_height * 4;
+	}
+	return size;
+}
+
+// Fills the mipmap chain that follows the base level with a 2x2 box filter.
+// The frame buffers are allocated with room for it, so unlike
+// Image::generate_mipmaps nothing is reallocated or copied on write.
+static void build_mipmaps(uint8_t *p_data, int p_width, int p_height) {
+	const uint8_t *src = p_data;
+	uint8_t *dst = p_data + (int64_t)p_width * p_height * 4;
+
+	while (p_width > 1 || p_height > 1) {
+		int width = MAX(1, p_width >> 1);
+		int height = MAX(1, p_height >> 1);
+		const int stride = p_width * 4;
+		uint8_t *out = dst;
+
+		for (int y = 0; y < height; y++) {
+			const uint8_t *row0 = src + (2 * y) * stride;
+			const uint8_t *row1 = src + MIN(2 * y + 1, p_height - 1) * stride;
+			for (int x = 0; x < width; x++) {
+				int x0 = (2 * x) * 4;
+				int x1 = MIN(2 * x + 1, p_width - 1) * 4;
+				for (int c = 0; c < 4; c++) {
+					*out++ = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+				}
+			}
+		}
+
+		src = dst;
+		dst += (int64_t)width * height * 4;
+		p_width = width;
+		p_height = height;
+	}
+}
+
 void MPVPlayer::update_frame() {
-	if (!mpv_gl) {
-		UtilityFunctions::push_warning("MPV: update_frame called but no render context");
-		return;
+	bool rendered = render_frame();
+	flush_render_log();
+	if (rendered) {
+		upload_frame();
 	}
+}
 
-	// Get video dimensions
-	Variant width_var = get_mpv_property("width");
-	Variant height_var = get_mpv_property("height");
+void MPVPlayer::flush_render_log() {
+	if (video_size_changed) {
+		UtilityFunctions::print(vformat("MPV: Video size: %dx%d", video_width, video_height));
+		video_size_changed = false;
+	}
+	if (frame_buffer_resized > 0) {
+		UtilityFunctions::print(vformat("MPV: Frame buffer resized to %d bytes", frame_buffer_resized));
+		frame_buffer_resized = 0;
+	}
 
-	if (width_var.get_type() == Variant::NIL || height_var.get_type() == Variant::NIL) {
-		UtilityFunctions::push_warning("MPV: Video dimensions not available yet");
+	// A problem that persists is reported once, not every frame
+	if (render_issue == reported_render_issue)
 		return;
+	reported_render_issue = render_issue;
+
+	switch (render_issue) {
+		case RENDER_ISSUE_NO_CONTEXT:
+			UtilityFunctions::push_warning("MPV: update_frame called but no render context");
+			break;
+		case RENDER_ISSUE_NO_DIMENSIONS:
+			UtilityFunctions::push_warning("MPV: Video dimensions not available yet");
+			break;
+		case RENDER_ISSUE_INVALID_DIMENSIONS:
+			UtilityFunctions::push_warning(vformat("MPV: Invalid video dimensions: %dx%d", observed_width, observed_height));
+			break;
+		case RENDER_ISSUE_FAILED:
+			UtilityFunctions::push_error(vformat("MPV: Render failed: %s", mpv_error_string(render_error)));
+			break;
+		default:
+			break;
 	}
+}
 
-	int64_t width = width_var.operator int64_t();
-	int64_t height = height_var.operator int64_t();
+bool MPVPlayer::render_frame() {
+	// May run on a WorkerThreadPool thread when scheduled_rendering is on;
+	// only touches mpv and frame_buffer, never the texture, the scene or the
+	// engine log (see flush_render_log).
+	if (!mpv_gl) {
+		render_issue = RENDER_ISSUE_NO_CONTEXT;
+		return false;
+	}
+	if (cached_clip)
+		return false;
+
+	MPVAllocProbe::Section alloc_section(MPVAllocProbe::SCOPE_RENDER);
+	uint64_t render_start = Time::get_singleton()->get_ticks_usec();
+
+	// Video dimensions come from observed properties; reading them here
+	// would cost a property round trip and a Variant per frame.
+	int64_t width = observed_width;
+	int64_t height = observed_height;
+
+	if (width == 0 || height == 0) {
+		render_issue = RENDER_ISSUE_NO_DIMENSIONS;
+		return false;
+	}
 
 	if (width <= 0 || height <= 0) {
-		UtilityFunctions::push_warning(vformat("MPV: Invalid video dimensions: %dx%d", width, height));
-		return;
+		render_issue = RENDER_ISSUE_INVALID_DIMENSIONS;
+		return false;
 	}
 
 	// Update dimensions if changed
 	if (video_width != (int)width || video_height != (int)height) {
 		video_width = (int)width;
 		video_height = (int)height;
-		UtilityFunctions::print(vformat("MPV: Video size: %dx%d", video_width, video_height));
+		video_size_changed = true;
 	}
 
-	// Prepare frame buffer
-	int frame_size = video_width * video_height * 4; // RGBA
-	if (frame_buffer.size() != frame_size) {
-		frame_buffer.resize(frame_size);
-		UtilityFunctions::print(vformat("MPV: Frame buffer resized to %d bytes", frame_size));
+	// mpv's SW renderer scales to whatever size we ask for. Packed alpha
+	// halves the width: mpv renders into composite_source and the compacted
+	// frame is written to the target, so no buffer changes size per frame.
+	int render_width = MAX(2, (int)(video_width * render_scale + 0.5));
+	bool packed_alpha = composite_mode == COMPOSITE_PACKED_ALPHA;
+	frame_width = packed_alpha ? render_width / 2 : render_width;
+	frame_height = MAX(2, (int)(video_height * render_scale + 0.5));
+
+	// Prepare frame buffer, with room for the mipmap chain when one is built;
+	// queued presentation renders into a queue slot instead
+	int frame_size = frame_data_size(frame_width, frame_height, generate_mipmaps);
+	QueuedFrame *slot = nullptr;
+	mpv_render_frame_info frame_info = {};
+	PackedByteArray *target_buffer = &frame_buffer;
+
+	if (presentation_queue_size > 0) {
+		{
+			MPVAllocProbe::Pause alloc_pause;
+			mpv_render_context_get_info(mpv_gl, { MPV_RENDER_PARAM_NEXT_FRAME_INFO, &frame_info });
+		}
+		// A redraw request without a new frame must not take a slot, or it
+		// could push a queued frame out.
+		if (!(frame_info.flags & MPV_RENDER_FRAME_INFO_PRESENT))
+			return false;
+		slot = acquire_queue_slot();
+		target_buffer = &slot->pixels;
+	}
+
+	if (target_buffer->size() != frame_size) {
+		target_buffer->resize(frame_size);
+		frame_buffer_resized = frame_size;
+	}
+
+	uint8_t *pixels = target_buffer->ptrw();
+	uint8_t *render_pixels = pixels;
+	if (packed_alpha) {
+		size_t render_size = (size_t)render_width * frame_height * 4;
+		if (composite_source.size() != render_size) {
+			composite_source.resize(render_size);
+		}
+		render_pixels = composite_source.data();
 	}
 
 	// Render frame - use proper lvalue variables
-	int size[2] = { video_width, video_height };
-	int stride = video_width * 4;
+	int size[2] = { render_width, frame_height };
+	int stride = render_width * 4;
 	const char *format = "rgba";
+	// Queued frames are released by target time, so mpv must not wait for it
+	int block_for_target_time = slot ? 0 : 1;
 
 	mpv_render_param render_params[] = {
 		{ MPV_RENDER_PARAM_SW_SIZE, size },
 		{ MPV_RENDER_PARAM_SW_FORMAT, const_cast<char *>(format) },
 		{ MPV_RENDER_PARAM_SW_STRIDE, &stride },
-		{ MPV_RENDER_PARAM_SW_POINTER, frame_buffer.ptrw() },
+		{ MPV_RENDER_PARAM_SW_POINTER, render_pixels },
+		{ MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target_time },
 		{ MPV_RENDER_PARAM_INVALID, nullptr }
 	};
 
-	int ret = mpv_render_context_render(mpv_gl, render_params);
+	int ret;
+	{
+		MPVAllocProbe::Pause alloc_pause;
+		ret = mpv_render_context_render(mpv_gl, render_params);
+	}
 	if (ret < 0) {
-		UtilityFunctions::push_error(vformat("MPV: Render failed: %s", mpv_error_string(ret)));
+		render_issue = RENDER_ISSUE_FAILED;
+		render_error = ret;
+		return false;
+	}
+	render_issue = RENDER_ISSUE_NONE;
+
+	if (composite_mode != COMPOSITE_NONE) {
+		composite_frame(render_pixels, pixels, render_width, frame_height);
+	}
+	if (generate_mipmaps) {
+		build_mipmaps(pixels, frame_width, frame_height);
+	}
+
+	if (slot) {
+		slot->width = frame_width;
+		slot->height = frame_height;
+		MPVAllocProbe::Pause alloc_pause;
+		slot->target_time = frame_info.target_time > 0 ? frame_info.target_time : mpv_get_time_us(mpv);
+		mpv_get_property(mpv, "time-pos", MPV_FORMAT_DOUBLE, &slot->pts);
+		slot->ready = true;
+	} else {
+		if (frame_rendered) {
+			// The previous frame was never uploaded; it is replaced, not queued.
+			render_stats.frames_dropped++;
+		}
+		frame_rendered = true;
+	}
+
+	render_stats.frames_rendered++;
+	render_stats.last_render_usec = Time::get_singleton()->get_ticks_usec() - render_start;
+	render_stats.render_usec_total += render_stats.last_render_usec;
+	return true;
+}
+
+void MPVPlayer::composite_frame(const uint8_t *p_src, uint8_t *p_dst, int p_width, int p_height) {
+	// Runs wherever render_frame runs, a render worker included. Chroma
+	// keying works in place (p_src is p_dst); packed alpha compacts the
+	// p_width wide source into p_dst.
+	static const MPVCompositor::Isa isa = MPVCompositor::get_best_isa();
+	uint64_t composite_start = Time::get_singleton()->get_ticks_usec();
+
+	if (composite_mode == COMPOSITE_CHROMA_KEY) {
+		MPVCompositor::chroma_key(isa, p_dst, (int64_t)p_width * p_height, chroma_key);
+	} else if (composite_mode == COMPOSITE_PACKED_ALPHA) {
+		MPVCompositor::packed_alpha(isa, p_src, p_dst, p_width, p_height);
+	}
+
+	render_stats.last_composite_usec = Time::get_singleton()->get_ticks_usec() - composite_start;
+	render_stats.composite_usec_total += render_stats.last_composite_usec;
+}
+
+void MPVPlayer::update_chroma_key() {
+	chroma_key = MPVCompositor::make_chroma_key(key_color.r, key_color.g, key_color.b, key_tolerance, key_softness, spill_suppression);
+}
+
+void MPVPlayer::set_composite_mode(CompositeMode p_mode) {
+	composite_mode = p_mode;
+	texture_needs_update.store(true);
+}
+
+void MPVPlayer::set_key_color(const Color &p_color) {
+	key_color = p_color;
+	update_chroma_key();
+}
+
+void MPVPlayer::set_key_tolerance(double p_tolerance) {
+	key_tolerance = CLAMP(p_tolerance, 0.0, 1.0);
+	update_chroma_key();
+}
+
+void MPVPlayer::set_key_softness(double p_softness) {
+	key_softness = CLAMP(p_softness, 0.0, 1.0);
+	update_chroma_key();
+}
+
+void MPVPlayer::set_spill_suppression(double p_amount) {
+	spill_suppression = CLAMP(p_amount, 0.0, 1.0);
+	update_chroma_key();
+}
+
+String MPVPlayer::get_compositor_isa() {
+	return MPVCompositor::get_isa_name(MPVCompositor::get_best_isa());
+}
+
+Dictionary MPVPlayer::benchmark_compositor(CompositeMode p_mode, int p_width, int p_height, int p_iterations) {
+	// Milliseconds per frame for every kernel set this CPU can run
+	Dictionary results;
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0 || p_iterations <= 0, results);
+
+	MPVChromaKey key = MPVCompositor::make_chroma_key(0.0f, 1.0f, 0.0f, 0.3f, 0.1f, 0.5f);
+	std::vector<uint8_t> source((size_t)p_width * p_height * 4);
+	for (size_t i = 0; i < source.size(); i++) {
+		source[i] = (uint8_t)((i * 2654435761u) >> 24);
+	}
+	std::vector<uint8_t> pixels(source.size());
+
+	for (int i = 0; i < MPVCompositor::ISA_MAX; i++) {
+		MPVCompositor::Isa isa = (MPVCompositor::Isa)i;
+		if (!MPVCompositor::is_isa_supported(isa))
+			continue;
+
+		uint64_t total_usec = 0;
+		for (int n = 0; n < p_iterations; n++) {
+			uint64_t start;
+			if (p_mode == COMPOSITE_PACKED_ALPHA) {
+				// Out of place, as render_frame runs it; the source stays intact
+				start = Time::get_singleton()->get_ticks_usec();
+				MPVCompositor::packed_alpha(isa, source.data(), pixels.data(), p_width, p_height);
+			} else {
+				// Chroma key works in place, so every pass starts from a fresh frame
+				pixels = source;
+				start = Time::get_singleton()->get_ticks_usec();
+				MPVCompositor::chroma_key(isa, pixels.data(), (int64_t)p_width * p_height, key);
+			}
+			total_usec += Time::get_singleton()->get_ticks_usec() - start;
+		}
+		results[MPVCompositor::get_isa_name(isa)] = total_usec / 1000.0 / p_iterations;
+	}
+	return results;
+}
+
+Dictionary MPVPlayer::verify_compositor(int p_width, int p_height) {
+	// Every kernel set this CPU can run against the scalar reference, on
+	// random frames, for both modes, both packed alpha overloads and a few
+	// key settings. Odd and tiny sizes are included so the SIMD tail
+	// handling is covered as well.
+	Dictionary results;
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0, results);
+
+	const MPVChromaKey keys[] = {
+		MPVCompositor::make_chroma_key(0.0f, 1.0f, 0.0f, 0.3f, 0.1f, 0.5f),
+		MPVCompositor::make_chroma_key(0.0f, 0.0f, 1.0f, 0.05f, 0.0f, 1.0f),
+		MPVCompositor::make_chroma_key(0.8f, 0.2f, 0.6f, 0.9f, 1.0f, 0.0f),
+	};
+	const int sizes[][2] = { { p_width, p_height }, { 37, 5 }, { 66, 3 }, { 2, 1 } };
+	// Past the end of the out-of-place destination, which must stay untouched
+	const size_t guard = 64;
+
+	uint32_t seed = 0x9e3779b9u;
+	for (int i = 0; i < MPVCompositor::ISA_MAX; i++) {
+		MPVCompositor::Isa isa = (MPVCompositor::Isa)i;
+		if (!MPVCompositor::is_isa_supported(isa))
+			continue;
+
+		bool matches = true;
+		for (const int *size : sizes) {
+			std::vector<uint8_t> source((size_t)size[0] * size[1] * 4);
+			for (uint8_t &byte : source) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				byte = (uint8_t)seed;
+			}
+
+			for (const MPVChromaKey &key : keys) {
+				std::vector<uint8_t> expected = source;
+				std::vector<uint8_t> actual = source;
+				MPVCompositor::chroma_key(MPVCompositor::ISA_SCALAR, expected.data(), (int64_t)size[0] * size[1], key);
+				MPVCompositor::chroma_key(isa, actual.data(), (int64_t)size[0] * size[1], key);
+				matches = matches && expected == actual;
+			}
+
+			std::vector<uint8_t> expected = source;
+			std::vector<uint8_t> actual = source;
+			MPVCompositor::packed_alpha(MPVCompositor::ISA_SCALAR, expected.data(), size[0], size[1]);
+			MPVCompositor::packed_alpha(isa, actual.data(), size[0], size[1]);
+			matches = matches && expected == actual;
+
+			// The out-of-place overload, which render_frame uses, must produce
+			// the same compacted frame and write nothing beyond it.
+			size_t packed_size = (size_t)(size[0] / 2) * size[1] * 4;
+			std::vector<uint8_t> packed(packed_size + guard, 0xa5);
+			MPVCompositor::packed_alpha(isa, source.data(), packed.data(), size[0], size[1]);
+			matches = matches && std::equal(packed.begin(), packed.begin() + packed_size, expected.begin());
+			matches = matches && std::all_of(packed.begin() + packed_size, packed.end(), [](uint8_t p_byte) { return p_byte == 0xa5; });
+		}
+
+		if (!matches) {
+			UtilityFunctions::push_error(vformat("MPV: %s compositor kernels differ from scalar", MPVCompositor::get_isa_name(isa)));
+		}
+		results[MPVCompositor::get_isa_name(isa)] = matches;
+	}
+	return results;
+}
+
+Dictionary MPVPlayer::get_allocation_counts() {
+	// Filled in only when demo/benchmarks/alloc_counter is preloaded
+	static const char *const scope_names[MPVAllocProbe::SCOPE_MAX] = { "render", "upload", "events" };
+	uint64_t allocations[MPVAllocProbe::SCOPE_MAX] = {};
+	uint64_t scopes[MPVAllocProbe::SCOPE_MAX] = {};
+	MPVAllocProbe::read(allocations, scopes);
+
+	Dictionary counts;
+	counts["available"] = MPVAllocProbe::is_available();
+	for (int i = 0; i < MPVAllocProbe::SCOPE_MAX; i++) {
+		counts[String(scope_names[i])] = allocations[i];
+		counts[String(scope_names[i]) + "_calls"] = scopes[i];
+	}
+	return counts;
+}
+
+void MPVPlayer::reset_allocation_counts() {
+	MPVAllocProbe::reset();
+}
+
+String MPVPlayer::get_clip_cache_key() const {
+	// Everything that changes the captured pixels
+	String key = vformat("%s|%.3f|%d", current_path, clip_cache_scale, composite_mode);
+	if (composite_mode == COMPOSITE_CHROMA_KEY) {
+		key += vformat("|%s|%.3f|%.3f|%.3f", key_color.to_html(false), key_tolerance, key_softness, spill_suppression);
+	}
+	return key;
+}
+
+void MPVPlayer::begin_clip_capture() {
+	clip_capture.reset();
+	if (!clip_cache_enabled || cached_clip || duration <= 0.0 || duration > clip_cache_max_duration)
+		return;
+
+	clip_capture = std::make_shared<MPVCachedClip>();
+	clip_capture->duration = duration;
+	clip_capture->compressed = clip_cache_compress;
+	clip_capture_last_pts = -1.0;
+	clip_capture_fps = 0.0;
+	if (mpv) {
+		mpv_get_property(mpv, "container-fps", MPV_FORMAT_DOUBLE, &clip_capture_fps);
+	}
+}
+
+void MPVPlayer::rearm_clip_capture() {
+	// Throw the partial pass away and wait for the clip to start over
+	clip_capture->frames.clear();
+	clip_capture->bytes = 0;
+	clip_capture_last_pts = -1.0;
+}
+
+void MPVPlayer::capture_clip_frame() {
+	MPVClipCache *cache = MPVClipCache::get_singleton();
+	double pts = presentation_queue_size > 0 ? presented_pts : current_time;
+
+	// Throttled players upload only some frames; a pass from one would be
+	// full of holes and get shared with every other player.
+	if (visibility_state != VISIBILITY_VISIBLE) {
+		rearm_clip_capture();
 		return;
 	}
 
-	// Update texture
+	if (clip_capture_last_pts < 0.0) {
+		// Only a pass captured from the very start can stand in for decoding
+		if (pts > 0.1)
+			return;
+	} else if (pts + clip_capture->duration * 0.5 < clip_capture_last_pts) {
+		// Wrapped around: the first pass is complete, unless frames were
+		// dropped or deferred along the way
+		std::shared_ptr<MPVCachedClip> clip = clip_capture;
+		clip_capture.reset();
+		int64_t expected = (int64_t)(clip->duration * clip_capture_fps);
+		if (clip_capture_fps > 0.0 && (int64_t)clip->frames.size() < expected * 9 / 10) {
+			UtilityFunctions::push_warning(vformat("MPV: Clip capture missed frames (%d of %d), not cached: %s",
+					(int64_t)clip->frames.size(), expected, current_path));
+			return;
+		}
+
+		std::shared_ptr<MPVCachedClip> shared = cache ? cache->insert(get_clip_cache_key(), clip) : nullptr;
+		if (shared && loop_enabled) {
+			start_clip_playback(shared, pts - clip_capture_first_pts);
+		}
+		return;
+	} else if (pts <= clip_capture_last_pts) {
+		return;
+	} else if (pts - clip_capture_last_pts > 0.5) {
+		UtilityFunctions::push_warning("MPV: Clip capture abandoned after a seek");
+		clip_capture.reset();
+		return;
+	}
+
+	int width = MAX(1, (int)(frame_width * clip_cache_scale + 0.5));
+	int height = MAX(1, (int)(frame_height * clip_cache_scale + 0.5));
+	if (!clip_capture->frames.empty() && (width != clip_capture->width || height != clip_capture->height)) {
+		// Quality or layout changed mid-pass; the next file load starts over
+		clip_capture.reset();
+		return;
+	}
+
+	if (clip_capture->frames.empty()) {
+		clip_capture_first_pts = pts;
+	}
+
+	MPVCachedClip::Frame frame;
+	frame.start = pts - clip_capture_first_pts;
+
+	// Base level only; the mipmap chain is rebuilt on upload
+	int base_size = frame_width * frame_height * 4;
+	PackedByteArray pixels = frame_buffer.size() == base_size ? frame_buffer : frame_buffer.slice(0, base_size);
+	if (width != frame_width || height != frame_height) {
+		Ref<Image> scaled = Image::create_from_data(frame_width, frame_height, false, Image::FORMAT_RGBA8, pixels);
+		scaled->resize(width, height, Image::INTERPOLATE_BILINEAR);
+		pixels = scaled->get_data();
+	}
+
+	clip_capture->width = width;
+	clip_capture->height = height;
+	clip_capture->frame_size = pixels.size();
+	frame.pixels = clip_cache_compress ? pixels.compress(FileAccess::COMPRESSION_ZSTD) : pixels;
+	clip_capture->bytes += frame.pixels.size();
+	clip_capture->frames.push_back(frame);
+	clip_capture_last_pts = pts;
+
+	if (cache && clip_capture->bytes > (int64_t)(cache->get_memory_budget_mb() * 1024.0 * 1024.0)) {
+		UtilityFunctions::push_warning(vformat("MPV: Clip too large for the clip cache: %s", current_path));
+		clip_capture.reset();
+	}
+}
+
+void MPVPlayer::start_clip_playback(const std::shared_ptr<MPVCachedClip> &p_clip, double p_time) {
+	cached_clip = p_clip;
+	clip_time = CLAMP(p_time, 0.0, p_clip->duration);
+	clip_frame = -1;
+	clip_paused = false;
+
+	// Nothing mpv rendered before the switch may be uploaded after it
+	frame_rendered = false;
+	for (QueuedFrame &frame : presentation_queue) {
+		frame.ready = false;
+	}
+
+	if (clip_cache_release_mpv) {
+		cleanup_mpv();
+		texture_needs_update.store(false);
+	} else if (mpv) {
+		// Keep the handle so load_file can reuse it, but stop decoding
+		const char *cmd[] = { "set", "pause", "yes", nullptr };
+		mpv_command_async(mpv, 0, cmd);
+	}
+}
+
+void MPVPlayer::stop_clip_playback() {
+	cached_clip.reset();
+	clip_frame = -1;
+}
+
+void MPVPlayer::advance_clip(double p_delta) {
+	if (!clip_paused) {
+		clip_time += p_delta * playback_speed;
+		if (clip_time >= cached_clip->duration) {
+			if (loop_enabled) {
+				clip_time = Math::fmod(clip_time, cached_clip->duration);
+			} else {
+				clip_time = cached_clip->duration;
+				clip_paused = true;
+				queue_signal(signal_playback_finished);
+			}
+		}
+	}
+	current_time = clip_time;
+	time_pos_stamp_usec = Time::get_singleton()->get_ticks_usec();
+
+	// Nothing to show while hidden; the clip keeps its place regardless
+	if (visibility_state >= VISIBILITY_HIDDEN)
+		return;
+
+	int index = cached_clip->find_frame(clip_time);
+	if (index == clip_frame)
+		return;
+	clip_frame = index;
+
+	frame_width = cached_clip->width;
+	frame_height = cached_clip->height;
+
+	if (!cached_clip->compressed && !generate_mipmaps) {
+		// Shares the cached frame's storage; nothing is copied
+		frame_buffer = cached_clip->frames[index].pixels;
+	} else {
+		// Into the buffer the image let go of at the last upload, so
+		// neither this nor the upload allocates
+		int data_size = frame_data_size(frame_width, frame_height, generate_mipmaps);
+		if (frame_buffer.size() != data_size) {
+			frame_buffer.resize(data_size);
+		}
+		if (!clip_decoder.decode(*cached_clip, index, frame_buffer.ptrw())) {
+			UtilityFunctions::push_error(vformat("MPV: Failed to decode cached clip frame %d", index));
+			return;
+		}
+		if (generate_mipmaps) {
+			build_mipmaps(frame_buffer.ptrw(), frame_width, frame_height);
+		}
+	}
+
+	frame_rendered = true;
+	upload_frame();
+}
+
+void MPVPlayer::upload_frame() {
+	if (!frame_rendered)
+		return;
+
+	MPVAllocProbe::Section alloc_section(MPVAllocProbe::SCOPE_UPLOAD);
+	frame_rendered = false;
+	uint64_t upload_start = Time::get_singleton()->get_ticks_usec();
+
+	// How long the previous frame stayed on screen; gaps from pauses and
+	// seeks are not cadence and would swamp the variance.
+	if (presentation_stats.last_upload_usec > 0) {
+		double shown_ms = (upload_start - presentation_stats.last_upload_usec) / 1000.0;
+		if (shown_ms < 250.0) {
+			presentation_stats.samples++;
+			double delta = shown_ms - presentation_stats.mean_ms;
+			presentation_stats.mean_ms += delta / presentation_stats.samples;
+			presentation_stats.m2 += delta * (shown_ms - presentation_stats.mean_ms);
+			presentation_stats.min_ms = presentation_stats.samples == 1 ? shown_ms : MIN(presentation_stats.min_ms, shown_ms);
+			presentation_stats.max_ms = MAX(presentation_stats.max_ms, shown_ms);
+		}
+	}
+	presentation_stats.last_upload_usec = upload_start;
+
+	// Update texture in place so every consumer sees the new frame
 	if (image.is_null()) {
 		image.instantiate();
 		UtilityFunctions::print("MPV: Image instance created");
 	}
 
-	image->set_data(video_width, video_height, false, Image::FORMAT_RGBA8, frame_buffer);
+	bool layout_changed = image->get_width() != frame_width || image->get_height() != frame_height ||
+			image->has_mipmaps() != generate_mipmaps;
+
+	// Rendered frames already carry their mipmap chain; clip cache frames
+	// and frames rendered before generate_mipmaps changed do not.
+	int data_size = frame_data_size(frame_width, frame_height, generate_mipmaps);
+	if (frame_buffer.size() != data_size) {
+		frame_buffer.resize(data_size);
+		if (generate_mipmaps) {
+			build_mipmaps(frame_buffer.ptrw(), frame_width, frame_height);
+		}
+	}
+
+	image->set_data(frame_width, frame_height, generate_mipmaps, Image::FORMAT_RGBA8, frame_buffer);
 
-	if (texture.is_null()) {
-		texture.instantiate();
-		UtilityFunctions::print("MPV: Texture instance created");
+	if (layout_changed) {
+		texture->set_image(image);
+	} else {
+		texture->update(image);
 	}
 
-	texture->set_image(image);
+	if (preview_enabled) {
+		update_preview();
+	}
 	queue_redraw();
+
+	if (clip_capture) {
+		capture_clip_frame();
+	}
+
+	render_stats.frames_uploaded++;
+	// The image now shares frame_buffer. Render the next frame into the
+	// other buffer, which the image has just let go of, so ptrw() does not
+	// copy-on-write a whole frame.
+	PackedByteArray uploaded = frame_buffer;
+	frame_buffer = spare_frame_buffer;
+	spare_frame_buffer = uploaded;
+
+	render_stats.last_upload_usec = Time::get_singleton()->get_ticks_usec() - upload_start;
+	render_stats.upload_usec_total += render_stats.last_upload_usec;
+}
+
+void MPVPlayer::update_preview() {
+	// Half-size 2x2 box filter, computed once per frame for all preview consumers.
+	int preview_width = MAX(1, frame_width / 2);
+	int preview_height = MAX(1, frame_height / 2);
+	int preview_size = preview_width * preview_height * 4;
+	if (preview_buffer.size() != preview_size) {
+		preview_buffer.resize(preview_size);
+	}
+
+	const uint8_t *src = frame_buffer.ptr();
+	uint8_t *dst = preview_buffer.ptrw();
+	const int stride = frame_width * 4;
+
+	for (int y = 0; y < preview_height; y++) {
+		const uint8_t *row0 = src + (2 * y) * stride;
+		const uint8_t *row1 = src + MIN(2 * y + 1, frame_height - 1) * stride;
+		for (int x = 0; x < preview_width; x++) {
+			int x0 = (2 * x) * 4;
+			int x1 = MIN(2 * x + 1, frame_width - 1) * 4;
+			for (int c = 0; c < 4; c++) {
+				*dst++ = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+			}
+		}
+	}
+
+	bool layout_changed = preview_image.is_null() || preview_image->get_width() != preview_width ||
+			preview_image->get_height() != preview_height;
+	if (preview_image.is_null()) {
+		preview_image.instantiate();
+	}
+
+	preview_image->set_data(preview_width, preview_height, false, Image::FORMAT_RGBA8, preview_buffer);
+	if (layout_changed) {
+		preview_texture->set_image(preview_image);
+	} else {
+		preview_texture->update(preview_image);
+	}
+
+	// Same double buffering as the full frame
+	PackedByteArray uploaded = preview_buffer;
+	preview_buffer = spare_preview_buffer;
+	spare_preview_buffer = uploaded;
 }
 
 void MPVPlayer::_notification(int p_what) {
 	switch (p_what) {
+		case NOTIFICATION_ENTER_TREE: {
+			update_display_refresh_rate();
+			if (scheduled_rendering && MPVRenderScheduler::get_singleton()) {
+				MPVRenderScheduler::get_singleton()->register_player(this);
+			}
+			break;
+		}
+		case NOTIFICATION_EXIT_TREE: {
+			if (MPVRenderScheduler::get_singleton()) {
+				MPVRenderScheduler::get_singleton()->unregister_player(this);
+			}
+			break;
+		}
 		case NOTIFICATION_PROCESS: {
-			if (!mpv)
-				return;
-
 			// Process MPV events
-			while (mpv) {
-				mpv_event *event = mpv_wait_event(mpv, 0);
-				if (event->event_id == MPV_EVENT_NONE)
-					break;
+			if (mpv) {
+				MPVAllocProbe::Section alloc_section(MPVAllocProbe::SCOPE_EVENTS);
+				while (mpv) {
+					mpv_event *event;
+					{
+						MPVAllocProbe::Pause alloc_pause;
+						event = mpv_wait_event(mpv, 0);
+					}
+					if (event->event_id == MPV_EVENT_NONE)
+						break;
 
-				// Log all events for debugging
-				//UtilityFunctions::print(vformat("MPV Event: %d", event->event_id));
+					// Log all events for debugging
+					//UtilityFunctions::print(vformat("MPV Event: %d", event->event_id));
 
-				switch (event->event_id) {
-					case MPV_EVENT_PLAYBACK_RESTART:
-						UtilityFunctions::print("MPV: Playback started/restarted");
-						break;
-					case MPV_EVENT_END_FILE: {
-						mpv_event_end_file *ef = (mpv_event_end_file *)event->data;
-						UtilityFunctions::print(vformat("MPV: End file, reason: %d", ef->reason));
-						if (ef->reason == MPV_END_FILE_REASON_EOF) {
-							call_deferred("playback_finished");
-						} else if (ef->reason == MPV_END_FILE_REASON_ERROR) {
-							UtilityFunctions::push_error(vformat("MPV: Playback error: %s", mpv_error_string(ef->error)));
+					switch (event->event_id) {
+						case MPV_EVENT_PLAYBACK_RESTART:
+							UtilityFunctions::print("MPV: Playback started/restarted");
+							playback_restarts++;
+							break;
+						case MPV_EVENT_END_FILE: {
+							mpv_event_end_file *ef = (mpv_event_end_file *)event->data;
+							UtilityFunctions::print(vformat("MPV: End file, reason: %d", ef->reason));
+							time_pos_valid = false;
+							if (ef->reason == MPV_END_FILE_REASON_EOF) {
+								queue_signal(signal_playback_finished);
+							} else if (ef->reason == MPV_END_FILE_REASON_ERROR) {
+								UtilityFunctions::push_error(vformat("MPV: Playback error: %s", mpv_error_string(ef->error)));
+							}
+							break;
 						}
-						break;
-					}
-					case MPV_EVENT_FILE_LOADED:
-						duration = get_mpv_property("duration").operator double();
-						UtilityFunctions::print(vformat("MPV: File loaded, duration: %f", duration));
-						emit_signal("file_loaded");
-						break;
-					case MPV_EVENT_LOG_MESSAGE: {
-						mpv_event_log_message *msg = (mpv_event_log_message *)event->data;
-						UtilityFunctions::print(vformat("MPV [%s]: %s", msg->prefix, msg->text));
-						break;
-					}
-					case MPV_EVENT_START_FILE:
-						UtilityFunctions::print("MPV: Starting file");
-						break;
-					case MPV_EVENT_VIDEO_RECONFIG:
-						UtilityFunctions::print("MPV: Video reconfigured");
-						break;
-					case MPV_EVENT_AUDIO_RECONFIG:
-						UtilityFunctions::print("MPV: Audio reconfigured");
-						break;
-					case MPV_EVENT_PROPERTY_CHANGE: {
-						mpv_event_property *prop = static_cast<mpv_event_property *>(event->data);
-						if (!prop || !prop->data)
+						case MPV_EVENT_FILE_LOADED:
+							duration = get_mpv_property("duration").operator double();
+							UtilityFunctions::print(vformat("MPV: File loaded, duration: %f", duration));
+							queue_signal(signal_file_loaded);
+							begin_clip_capture();
 							break;
-						switch (event->reply_userdata) {
-							/* case 1:
-								time_pos = *static_cast<double *>(prop->data);
-								call_deferred("emit_signal", "time_changed", time_pos);
-								break;*/
-							case 2: {
-								bool paused_for_cache = *static_cast<int *>(prop->data) != 0;
-								if (paused_for_cache && !is_buffering) {
-									is_buffering = true;
-									call_deferred("emit_signal", "buffering_started");
-								} else if (!paused_for_cache && is_buffering) {
-									is_buffering = false;
-									call_deferred("emit_signal", "buffering_ended");
-								}
+						case MPV_EVENT_LOG_MESSAGE: {
+							mpv_event_log_message *msg = (mpv_event_log_message *)event->data;
+							UtilityFunctions::print(vformat("MPV [%s]: %s", msg->prefix, msg->text));
+							break;
+						}
+						case MPV_EVENT_START_FILE:
+							UtilityFunctions::print("MPV: Starting file");
+							break;
+						case MPV_EVENT_VIDEO_RECONFIG:
+							UtilityFunctions::print("MPV: Video reconfigured");
+							break;
+						case MPV_EVENT_AUDIO_RECONFIG:
+							UtilityFunctions::print("MPV: Audio reconfigured");
+							break;
+						case MPV_EVENT_PROPERTY_CHANGE: {
+							mpv_event_property *prop = static_cast<mpv_event_property *>(event->data);
+							if (!prop)
 								break;
-							}
-							case 3: {
-								bool core_idle = *static_cast<int *>(prop->data);
-								if (core_idle && !is_buffering) {
-									is_buffering = true;
-									call_deferred("emit_signal", "buffering_started");
-								} else if (!core_idle && is_buffering) {
-									is_buffering = false;
-									call_deferred("emit_signal", "buffering_ended");
+							if (!prop->data) {
+								// Dimensions go unavailable between files
+								if (event->reply_userdata == 8 || event->reply_userdata == 9) {
+									observed_width = 0;
+									observed_height = 0;
 								}
 								break;
 							}
-							case 4: {
-								if (prop->format == MPV_FORMAT_STRING && prop->data) {
-									char *sub_text = *static_cast<char **>(prop->data);
-									if (sub_text != nullptr) {
-										String subtitle_text = String::utf8(sub_text);
-										// Only emit if text changed to avoid spam
-										if (subtitle_text != last_subtitle_text) {
-											last_subtitle_text = subtitle_text;
-											call_deferred("emit_signal", "subtitle_changed", subtitle_text);
-										}
+							switch (event->reply_userdata) {
+								case 0:
+									// Stamped so the clock can be extrapolated between updates
+									current_time = *static_cast<double *>(prop->data);
+									time_pos_stamp_usec = Time::get_singleton()->get_ticks_usec();
+									time_pos_valid = true;
+									break;
+								case 1:
+									paused_state = *static_cast<int *>(prop->data) != 0;
+									time_pos_stamp_usec = Time::get_singleton()->get_ticks_usec();
+									break;
+								case 2: {
+									bool paused_for_cache = *static_cast<int *>(prop->data) != 0;
+									if (paused_for_cache && !is_buffering) {
+										is_buffering = true;
+										queue_signal(signal_buffering_started);
+									} else if (!paused_for_cache && is_buffering) {
+										is_buffering = false;
+										queue_signal(signal_buffering_ended);
 									}
-								} else {
-									// No subtitle or subtitle cleared
-									if (!last_subtitle_text.is_empty()) {
-										last_subtitle_text = "";
-										call_deferred("emit_signal", "subtitle_changed", String(""));
+									break;
+								}
+								case 3: {
+									bool core_idle = *static_cast<int *>(prop->data);
+									if (core_idle && !is_buffering) {
+										is_buffering = true;
+										queue_signal(signal_buffering_started);
+									} else if (!core_idle && is_buffering) {
+										is_buffering = false;
+										queue_signal(signal_buffering_ended);
 									}
+									break;
 								}
+								case 4: {
+									if (prop->format == MPV_FORMAT_STRING && prop->data) {
+										char *sub_text = *static_cast<char **>(prop->data);
+										// Only convert and emit if text changed to avoid spam
+										if (sub_text != nullptr && last_subtitle_raw != sub_text) {
+											last_subtitle_raw = sub_text;
+											last_subtitle_text = String::utf8(sub_text);
+											queue_signal(signal_subtitle_changed, last_subtitle_text);
+										}
+									} else {
+										// No subtitle or subtitle cleared
+										if (!last_subtitle_text.is_empty()) {
+											last_subtitle_raw.clear();
+											last_subtitle_text = String();
+											queue_signal(signal_subtitle_changed, last_subtitle_text);
+										}
+									}
+									break;
+								}
+								case 5:
+									frame_drop_count = *static_cast<int64_t *>(prop->data);
+									break;
+								case 6:
+									decoder_frame_drop_count = *static_cast<int64_t *>(prop->data);
+									break;
+								case 8:
+									observed_width = *static_cast<int64_t *>(prop->data);
+									break;
+								case 9:
+									observed_height = *static_cast<int64_t *>(prop->data);
+									break;
+								case 7:
+									// Extrapolate up to now at the old rate before switching
+									current_time = get_estimated_time_pos();
+									time_pos_stamp_usec = Time::get_singleton()->get_ticks_usec();
+									playback_speed = *static_cast<double *>(prop->data);
+									break;
 							}
+							break;
 						}
-						break;
+						default:
+							break;
 					}
-					default:
-						break;
 				}
 			}
+
+			// After the drain, and outside it, so handlers may call back in
+			emit_pending_signals();
 			break;
 		} 
 	}
 }
 
+void MPVPlayer::queue_signal(const StringName &p_signal) {
+	pending_signals.push_back({ &p_signal, String(), false });
+}
+
+void MPVPlayer::queue_signal(const StringName &p_signal, const String &p_text) {
+	pending_signals.push_back({ &p_signal, p_text, true });
+}
+
+void MPVPlayer::emit_pending_signals() {
+	// Handlers may queue more (load_file on a clip cache hit), so index
+	// rather than iterate, and copy the entry before emitting it.
+	for (size_t i = 0; i < pending_signals.size(); i++) {
+		PendingSignal pending = pending_signals[i];
+		if (pending.has_text) {
+			emit_signal(*pending.name, pending.text);
+		} else {
+			emit_signal(*pending.name);
+		}
+	}
+	pending_signals.clear();
+}
+
 void MPVPlayer::_process(double delta) {
-	// Check if we need to update the texture
-	if (texture_needs_update.load()) {
-		// Reset the flag at the beginning to avoid missing frames
-		texture_needs_update.store(false);
+	update_visibility(delta);
+
+	if (cached_clip) {
+		advance_clip(delta);
+		return;
+	}
+
+	if (adaptive_quality && visibility_state < VISIBILITY_HIDDEN) {
+		// Work done for this player since the last tick, whoever rendered it
+		uint64_t work_usec = render_stats.render_usec_total + render_stats.upload_usec_total;
+		double work_ms = (work_usec - governor_work_usec) / 1000.0;
+		governor_work_usec = work_usec;
+
+		// CPU time of the last frame; delta would just be the vsync interval
+		double process_ms = Performance::get_singleton()->get_monitor(Performance::TIME_PROCESS) * 1000.0;
+		int level = quality_governor.update(quality_level, delta, process_ms, work_ms, frame_drop_count + decoder_frame_drop_count,
+				visibility_state == VISIBILITY_VISIBLE);
+		if (level >= 0) {
+			set_quality_level(level);
+		}
+	}
+
+	if (mpv_gl && presentation_queue_size > 0) {
+		// Lets video-sync=display lock mpv's clock to our frame cadence
+		mpv_render_context_report_swap(mpv_gl);
+	}
+
+	// Rendering and upload are driven by MPVRenderScheduler instead
+	if (scheduled_rendering) {
+		return;
+	}
 
+	// Check if we need to update the texture
+	if (consume_frame_request()) {
 		update_frame();
+	}
+
+	if (presentation_queue_size > 0 && release_due_frame()) {
+		upload_frame();
+	}
+}
+
+MPVPlayer::QueuedFrame *MPVPlayer::acquire_queue_slot() {
+	QueuedFrame *oldest = nullptr;
+	for (QueuedFrame &frame : presentation_queue) {
+		if (!frame.ready)
+			return &frame;
+		if (!oldest || frame.target_time < oldest->target_time)
+			oldest = &frame;
+	}
+
+	// Queue full: mpv is ahead of the display, give up the oldest frame
+	presentation_stats.frames_overflowed++;
+	oldest->ready = false;
+	return oldest;
+}
+
+bool MPVPlayer::release_due_frame() {
+	// Queue slots are only touched from the main thread or from the
+	// scheduler's render pass, which has completed before uploads start.
+	if (!mpv || cached_clip)
+		return false;
+
+	// The frame uploaded now is shown at the next vsync (plus whatever
+	// latency the caller configured); take the newest one due by then.
+	double interval_us = 1000000.0 / display_refresh_rate;
+	double latency_us = presentation_latency_ms >= 0.0 ? presentation_latency_ms * 1000.0 : interval_us;
+	int64_t deadline = mpv_get_time_us(mpv) + (int64_t)(latency_us + interval_us * 0.5);
+
+	QueuedFrame *due = nullptr;
+	for (QueuedFrame &frame : presentation_queue) {
+		if (frame.ready && frame.target_time <= deadline && (!due || frame.target_time > due->target_time)) {
+			due = &frame;
+		}
+	}
+	if (!due)
+		return false;
+
+	for (QueuedFrame &frame : presentation_queue) {
+		if (frame.ready && &frame != due && frame.target_time < due->target_time) {
+			frame.ready = false;
+			presentation_stats.frames_late++;
+		}
+	}
+
+	// Swap buffers rather than copy; the slot inherits the old frame buffer
+	PackedByteArray released = due->pixels;
+	due->pixels = frame_buffer;
+	frame_buffer = released;
+	due->ready = false;
+
+	frame_width = due->width;
+	frame_height = due->height;
+	presented_pts = due->pts;
+	presentation_stats.frames_released++;
+
+	frame_rendered = true;
+	return true;
+}
+
+void MPVPlayer::update_display_refresh_rate() {
+	double rate = DisplayServer::get_singleton()->screen_get_refresh_rate();
+	display_refresh_rate = rate > 0.0 ? rate : 60.0;
+
+	if (!mpv)
+		return;
+
+	if (presentation_queue_size > 0) {
+		CharString fps = String::num(display_refresh_rate).utf8();
+		mpv_set_property_string(mpv, "display-fps-override", fps.get_data());
+	} else {
+		// Back to mpv's own idea of the display rate
+		mpv_set_property_string(mpv, "display-fps-override", "0");
+	}
+}
+
+void MPVPlayer::set_presentation_queue_size(int p_size) {
+	presentation_queue_size = CLAMP(p_size, 0, 8);
+	presentation_queue.clear();
+	presentation_queue.resize(presentation_queue_size);
+	update_display_refresh_rate();
+}
+
+void MPVPlayer::set_presentation_latency_ms(double p_latency) {
+	presentation_latency_ms = p_latency;
+}
+
+void MPVPlayer::set_clip_cache_max_duration(double p_seconds) {
+	clip_cache_max_duration = MAX(0.0, p_seconds);
+}
+
+void MPVPlayer::set_clip_cache_scale(double p_scale) {
+	clip_cache_scale = CLAMP(p_scale, 0.1, 1.0);
+}
+
+Dictionary MPVPlayer::get_presentation_stats() const {
+	int depth = 0;
+	for (const QueuedFrame &frame : presentation_queue) {
+		depth += frame.ready ? 1 : 0;
+	}
+
+	double variance = presentation_stats.samples > 1 ? presentation_stats.m2 / (presentation_stats.samples - 1) : 0.0;
+
+	Dictionary stats;
+	stats["queue_depth"] = depth;
+	stats["frames_released"] = presentation_stats.frames_released;
+	stats["frames_late"] = presentation_stats.frames_late;
+	stats["frames_overflowed"] = presentation_stats.frames_overflowed;
+	stats["display_refresh_rate"] = display_refresh_rate;
+	stats["presented_pts"] = presented_pts;
+	stats["samples"] = presentation_stats.samples;
+	stats["display_ms_mean"] = presentation_stats.mean_ms;
+	stats["display_ms_variance"] = variance;
+	stats["display_ms_stddev"] = Math::sqrt(variance);
+	stats["display_ms_min"] = presentation_stats.min_ms;
+	stats["display_ms_max"] = presentation_stats.max_ms;
+	return stats;
+}
+
+void MPVPlayer::reset_presentation_stats() {
+	presentation_stats = PresentationStats();
+}
+
+bool MPVPlayer::consume_frame_request() {
+	// Reset the flag at the beginning to avoid missing frames
+	if (!texture_needs_update.exchange(false))
+		return false;
+
+	// A kept-alive mpv must not draw over the cached clip
+	if (cached_clip) {
+		skip_frame();
+		return false;
+	}
+
+	switch (visibility_state) {
+		case VISIBILITY_VISIBLE:
+			return true;
+		case VISIBILITY_PARTIAL:
+			if (++reduced_frame_counter % reduced_render_interval == 0)
+				return true;
+			visibility_skipped[VISIBILITY_PARTIAL]++;
+			skip_frame();
+			return false;
+		default:
+			visibility_skipped[visibility_state]++;
+			skip_frame();
+			return false;
+	}
+}
+
+void MPVPlayer::skip_frame() {
+	// The frame must still be consumed: vo_libmpv's flip_page waits for a
+	// render call and drops the frame when none comes. Only the copy into
+	// frame_buffer and the upload are saved.
+	if (!mpv_gl)
+		return;
+
+	int skip_rendering = 1;
+	int block_for_target_time = 0;
+	mpv_render_param render_params[] = {
+		{ MPV_RENDER_PARAM_SKIP_RENDERING, &skip_rendering },
+		{ MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target_time },
+		{ MPV_RENDER_PARAM_INVALID, nullptr }
+	};
+	mpv_render_context_render(mpv_gl, render_params);
+}
+
+// Screen-space rect of a control, clipped by the viewport and every
+// clipping ancestor.
+static Rect2 get_visible_rect(const Control *p_control) {
+	Rect2 visible = p_control->get_global_transform_with_canvas().xform(Rect2(Vector2(), p_control->get_size()));
+	visible = visible.intersection(Rect2(Vector2(), p_control->get_viewport()->get_visible_rect().size));
+
+	for (Node *parent = p_control->get_parent(); parent && visible.has_area(); parent = parent->get_parent()) {
+		Control *control = Object::cast_to<Control>(parent);
+		if (control && control->is_clipping_contents()) {
+			visible = visible.intersection(control->get_global_transform_with_canvas().xform(Rect2(Vector2(), control->get_size())));
+		}
+	}
+
+	return visible;
+}
+
+MPVPlayer::VisibilityState MPVPlayer::compute_visibility() const {
+	// Only fan-out TextureRect targets are considered; the player's own
+	// Control does not draw the frame. Without a TextureRect consumer we
+	// cannot tell where the frame ends up (materials, get_texture() users),
+	// so stay conservative.
+	if (rect_targets.empty() || !material_targets.empty())
+		return VISIBILITY_VISIBLE;
+
+	VisibilityState best = VISIBILITY_HIDDEN;
+	bool any_valid = false;
+
+	for (const RectTarget &target : rect_targets) {
+		TextureRect *rect = Object::cast_to<TextureRect>(ObjectDB::get_instance(target.id));
+		if (!rect || !rect->is_inside_tree())
+			continue;
+		any_valid = true;
+
+		if (!rect->is_visible_in_tree())
+			continue;
+
+		Rect2 visible = get_visible_rect(rect);
+		if (!visible.has_area())
+			continue;
+
+		if (visible.get_area() >= small_tile_area)
+			return VISIBILITY_VISIBLE;
+		best = VISIBILITY_PARTIAL;
+	}
+
+	return any_valid ? best : VISIBILITY_VISIBLE;
+}
+
+double MPVPlayer::get_visible_target_area(bool &r_focused) const {
+	double area = 0.0;
+	r_focused = false;
+
+	for (const RectTarget &target : rect_targets) {
+		TextureRect *rect = Object::cast_to<TextureRect>(ObjectDB::get_instance(target.id));
+		if (!rect || !rect->is_inside_tree() || !rect->is_visible_in_tree())
+			continue;
+		Rect2 visible = get_visible_rect(rect);
+		if (!visible.has_area())
+			continue;
+		area += visible.get_area();
+		r_focused = r_focused || rect->has_focus();
+	}
+
+	// Materials and get_texture() users may show the frame anywhere; count
+	// them as one tile that is just large enough to render at full quality.
+	if (rect_targets.empty() || !material_targets.empty())
+		area = MAX(area, small_tile_area);
+
+	return area;
+}
+
+void MPVPlayer::update_visibility(double p_delta) {
+	VisibilityState state = VISIBILITY_VISIBLE;
+
+	if (visibility_throttling) {
+		state = compute_visibility();
+		if (state == VISIBILITY_HIDDEN) {
+			hidden_time += p_delta;
+			if (hidden_time >= suspend_delay) {
+				state = VISIBILITY_SUSPENDED;
+			}
+		} else {
+			hidden_time = 0.0;
+		}
+	}
+
+	visibility_time[visibility_state] += p_delta;
+	if (state != visibility_state) {
+		set_visibility_state(state);
+	}
+}
+
+void MPVPlayer::set_visibility_state(VisibilityState p_state) {
+	VisibilityState previous = visibility_state;
+	visibility_state = p_state;
+
+	if (mpv && p_state == VISIBILITY_SUSPENDED) {
+		if (suspend_mode == SUSPEND_DISABLE_VIDEO) {
+			char *vid = mpv_get_property_string(mpv, "vid");
+			suspended_vid = vid ? String(vid) : String("auto");
+			mpv_free(vid);
+			mpv_set_property_string(mpv, "vid", "no");
+		} else {
+			// Decoder options only take effect on reinit, hence the reload
+			mpv_set_property_string(mpv, "vd-lavc-skipframe", "nonkey");
+			const char *cmd[] = { "video-reload", nullptr };
+			mpv_command_async(mpv, 0, cmd);
+		}
+	} else if (mpv && previous == VISIBILITY_SUSPENDED) {
+		if (suspend_mode == SUSPEND_DISABLE_VIDEO) {
+			mpv_set_property_string(mpv, "vid", suspended_vid.is_empty() ? "auto" : suspended_vid.utf8().get_data());
+		} else {
+			mpv_set_property_string(mpv, "vd-lavc-skipframe", "default");
+			const char *cmd[] = { "video-reload", nullptr };
+			mpv_command_async(mpv, 0, cmd);
+		}
+	}
+
+	if (clip_capture && p_state != VISIBILITY_VISIBLE) {
+		rearm_clip_capture();
+	}
+
+	if (previous >= VISIBILITY_HIDDEN && p_state < VISIBILITY_HIDDEN) {
+		// Redraw straight away instead of waiting for mpv's next frame
+		texture_needs_update.store(true);
+	}
+
+	emit_signal("visibility_state_changed", p_state);
+}
+
+void MPVPlayer::set_visibility_throttling(bool p_enabled) {
+	visibility_throttling = p_enabled;
+}
 
-		//_update_texture_internal();
+void MPVPlayer::set_suspend_delay(double p_seconds) {
+	suspend_delay = MAX(0.0, p_seconds);
+}
+
+void MPVPlayer::set_suspend_mode(SuspendMode p_mode) {
+	// Changing modes while suspended would leave the old one applied
+	if (visibility_state == VISIBILITY_SUSPENDED) {
+		set_visibility_state(VISIBILITY_HIDDEN);
 	}
+	suspend_mode = p_mode;
+}
+
+void MPVPlayer::set_small_tile_area(double p_area) {
+	small_tile_area = MAX(0.0, p_area);
+}
+
+void MPVPlayer::set_reduced_render_interval(int p_interval) {
+	reduced_render_interval = MAX(1, p_interval);
 }
 
 void MPVPlayer::set_target_texture_rect(TextureRect *rect) {
-	target_texture_rect = rect;
+	rect_targets.clear();
+
+	if (rect) {
+		add_target_texture_rect(rect, false);
+	}
+}
+
+void MPVPlayer::add_target_texture_rect(TextureRect *p_rect, bool p_preview) {
+	ERR_FAIL_NULL(p_rect);
+
+	ObjectID id = ObjectID(p_rect->get_instance_id());
+	bool found = false;
+	for (RectTarget &target : rect_targets) {
+		if (target.id == id) {
+			target.preview = p_preview;
+			found = true;
+		}
+	}
+	if (!found) {
+		rect_targets.push_back({ id, p_preview });
+	}
+
+	if (p_preview) {
+		set_preview_enabled(true);
+	}
+	p_rect->set_texture(p_preview ? preview_texture : texture);
+}
+
+void MPVPlayer::remove_target_texture_rect(TextureRect *p_rect) {
+	ERR_FAIL_NULL(p_rect);
+
+	ObjectID id = ObjectID(p_rect->get_instance_id());
+	for (size_t i = 0; i < rect_targets.size(); i++) {
+		if (rect_targets[i].id == id) {
+			rect_targets.erase(rect_targets.begin() + i);
+			break;
+		}
+	}
+
+	Ref<Texture2D> current = p_rect->get_texture();
+	if (current.ptr() == texture.ptr() || current.ptr() == preview_texture.ptr()) {
+		p_rect->set_texture(Ref<Texture2D>());
+	}
+}
+
+void MPVPlayer::add_target_material(const Ref<Material> &p_material, const StringName &p_parameter, bool p_preview) {
+	ERR_FAIL_COND(p_material.is_null());
+
+	remove_target_material(p_material);
+	material_targets.push_back({ p_material, p_parameter, p_preview });
+
+	if (p_preview) {
+		set_preview_enabled(true);
+	}
+	bind_target_texture(material_targets.back());
+}
+
+void MPVPlayer::remove_target_material(const Ref<Material> &p_material) {
+	for (size_t i = 0; i < material_targets.size(); i++) {
+		if (material_targets[i].material == p_material) {
+			material_targets.erase(material_targets.begin() + i);
+			return;
+		}
+	}
+}
+
+void MPVPlayer::bind_target_texture(const MaterialTarget &p_target) {
+	Ref<Texture2D> target_texture = p_target.preview ? preview_texture : texture;
+
+	ShaderMaterial *shader_material = Object::cast_to<ShaderMaterial>(p_target.material.ptr());
+	if (shader_material) {
+		shader_material->set_shader_parameter(p_target.parameter, target_texture);
+	} else {
+		// e.g. StandardMaterial3D with "albedo_texture"
+		p_target.material->set(p_target.parameter, target_texture);
+	}
+}
+
+void MPVPlayer::clear_targets() {
+	rect_targets.clear();
+	material_targets.clear();
+}
+
+void MPVPlayer::set_generate_mipmaps(bool p_enabled) {
+	generate_mipmaps = p_enabled;
+}
+
+void MPVPlayer::set_preview_enabled(bool p_enabled) {
+	preview_enabled = p_enabled;
+}
+
+void MPVPlayer::set_scheduled_rendering(bool p_enabled) {
+	if (scheduled_rendering == p_enabled)
+		return;
+
+	scheduled_rendering = p_enabled;
+
+	MPVRenderScheduler *scheduler = MPVRenderScheduler::get_singleton();
+	if (!scheduler || !is_inside_tree())
+		return;
+
+	if (scheduled_rendering) {
+		scheduler->register_player(this);
+	} else {
+		scheduler->unregister_player(this);
+		// Hand a frame the scheduler rendered but never uploaded back to _process
+		upload_frame();
+	}
+}
+
+void MPVPlayer::set_render_priority(double p_priority) {
+	render_priority = p_priority;
+}
+
+void MPVPlayer::apply_quality_level(int p_level, int p_previous) {
+	const MPVQualityLevel &level = MPVQualityGovernor::LEVELS[p_level];
+	render_scale = level.render_scale;
+
+	if (!mpv)
+		return;
+
+	mpv_set_property_string(mpv, "sws-scaler", level.sws_scaler);
+	mpv_set_property_string(mpv, "zimg-scaler", level.zimg_scaler);
+	mpv_set_property_string(mpv, "sws-fast", level.sws_fast);
+	mpv_set_property_string(mpv, "vd-lavc-skiploopfilter", level.skiploopfilter);
+	mpv_set_property_string(mpv, "vd-lavc-fast", level.lavc_fast);
+
+	if (p_previous < 0)
+		return;
 
-	// If we already have a texture, apply it immediately
-	if (target_texture_rect && texture.is_valid()) {
-		target_texture_rect->set_texture(texture);
+	// Decoder options only take effect on reinit; skip the reload when only
+	// the scaler or render size changed.
+	const MPVQualityLevel &previous = MPVQualityGovernor::LEVELS[p_previous];
+	if (strcmp(previous.skiploopfilter, level.skiploopfilter) != 0 || strcmp(previous.lavc_fast, level.lavc_fast) != 0) {
+		const char *cmd[] = { "video-reload", nullptr };
+		mpv_command_async(mpv, 0, cmd);
 	}
 }
 
+void MPVPlayer::set_adaptive_quality(bool p_enabled) {
+	adaptive_quality = p_enabled;
+	quality_governor.reset();
+	governor_work_usec = render_stats.render_usec_total + render_stats.upload_usec_total;
+}
+
+void MPVPlayer::set_quality_level(int p_level) {
+	p_level = CLAMP(p_level, 0, MPVQualityGovernor::LEVEL_COUNT - 1);
+	if (p_level == quality_level)
+		return;
+
+	int previous = quality_level;
+	quality_level = p_level;
+	apply_quality_level(quality_level, previous);
+
+	UtilityFunctions::print(vformat("MPV: Quality level %s -> %s", MPVQualityGovernor::LEVELS[previous].name, MPVQualityGovernor::LEVELS[quality_level].name));
+	emit_signal("quality_changed", quality_level);
+}
+
+String MPVPlayer::get_quality_level_name() const {
+	return MPVQualityGovernor::LEVELS[quality_level].name;
+}
+
+void MPVPlayer::set_target_frame_budget_ms(double p_budget) {
+	quality_governor.budget_ms = MAX(1.0, p_budget);
+}
+
+Dictionary MPVPlayer::get_render_stats() const {
+	Dictionary stats;
+	stats["frames_rendered"] = render_stats.frames_rendered;
+	stats["frames_uploaded"] = render_stats.frames_uploaded;
+	stats["frames_dropped"] = render_stats.frames_dropped;
+	stats["frames_deferred"] = render_stats.frames_deferred;
+	stats["last_render_usec"] = render_stats.last_render_usec;
+	stats["last_upload_usec"] = render_stats.last_upload_usec;
+	stats["render_usec_total"] = render_stats.render_usec_total;
+	stats["upload_usec_total"] = render_stats.upload_usec_total;
+	stats["last_composite_usec"] = render_stats.last_composite_usec;
+	stats["composite_usec_total"] = render_stats.composite_usec_total;
+	stats["compositor_isa"] = get_compositor_isa();
+	stats["clip_capturing"] = clip_capture != nullptr;
+	stats["clip_cached"] = cached_clip != nullptr;
+
+	static const char *state_names[VISIBILITY_MAX] = { "visible", "partial", "hidden", "suspended" };
+	uint64_t skipped = 0;
+	for (int i = 0; i < VISIBILITY_MAX; i++) {
+		stats[vformat("time_%s", state_names[i])] = visibility_time[i];
+		stats[vformat("frames_skipped_%s", state_names[i])] = visibility_skipped[i];
+		skipped += visibility_skipped[i];
+	}
+	stats["visibility_state"] = visibility_state;
+	stats["quality_level"] = quality_level;
+	stats["frame_drop_count"] = frame_drop_count;
+	stats["decoder_frame_drop_count"] = decoder_frame_drop_count;
+
+	// Frames not rendered, priced at the measured average render+upload cost
+	uint64_t average_usec = render_stats.frames_uploaded > 0
+			? (render_stats.render_usec_total + render_stats.upload_usec_total) / render_stats.frames_uploaded
+			: 0;
+	stats["estimated_usec_saved"] = skipped * average_usec;
+	return stats;
+}
+
 void MPVPlayer::load_file(const String &p_path) {
+	stop_clip_playback();
+	clip_capture.reset();
+	current_path = p_path;
+
+	if (clip_cache_enabled && MPVClipCache::get_singleton()) {
+		std::shared_ptr<MPVCachedClip> clip = MPVClipCache::get_singleton()->acquire(get_clip_cache_key());
+		if (clip) {
+			UtilityFunctions::print(vformat("MPV: Playing from clip cache: %s", p_path));
+			if (mpv) {
+				const char *cmd[] = { "stop", nullptr };
+				mpv_command_async(mpv, 0, cmd);
+			}
+			start_clip_playback(clip, 0.0);
+			duration = clip->duration;
+			// Queued like the mpv path's, so it is emitted from the next
+			// process step and callers can still connect after load_file
+			queue_signal(signal_file_loaded);
+			return;
+		}
+	}
+
+	// The handle may have been released by a clip cache hit
+	if (!mpv) {
+		initialize_mpv();
+		if (mpv && loop_enabled) {
+			set_loop(true);
+		}
+	}
+
 	if (!mpv) {
 		UtilityFunctions::push_error("MPV: Cannot load file, mpv not initialized");
 		return;
@@ -351,14 +1656,14 @@ void MPVPlayer::load_file(const String &p_path) {
 		return;
 	}
 
-	// Observe time position and pause state
-	mpv_observe_property(mpv, 0, "time-pos", MPV_FORMAT_DOUBLE);
-	mpv_observe_property(mpv, 1, "pause", MPV_FORMAT_FLAG);
-
 	UtilityFunctions::print("MPV: Load command sent successfully");
 }
 
 void MPVPlayer::play() {
+	if (cached_clip) {
+		clip_paused = false;
+		return;
+	}
 	if (!mpv)
 		return;
 	const char *cmd[] = { "set", "pause", "no", nullptr };
@@ -366,6 +1671,10 @@ void MPVPlayer::play() {
 }
 
 void MPVPlayer::pause() {
+	if (cached_clip) {
+		clip_paused = true;
+		return;
+	}
 	if (!mpv)
 		return;
 	const char *cmd[] = { "set", "pause", "yes", nullptr };
@@ -373,14 +1682,21 @@ void MPVPlayer::pause() {
 }
 
 void MPVPlayer::stop() {
+	stop_clip_playback();
+	clip_capture.reset();
 	if (!mpv)
 		return;
 	const char *cmd[] = { "stop", nullptr };
 	mpv_command(mpv, cmd);
 	current_time = 0.0;
+	time_pos_valid = false;
 }
 
 void MPVPlayer::seek(String seconds, bool relative) {
+	if (cached_clip) {
+		clip_time = CLAMP((relative ? clip_time : 0.0) + seconds.to_float(), 0.0, cached_clip->duration);
+		return;
+	}
 	if (!mpv)
 		return;
 	const char *seek_cmd[] = { "seek", seconds.utf8().get_data(), relative ? "relative" : "absolute", nullptr };
@@ -388,6 +1704,10 @@ void MPVPlayer::seek(String seconds, bool relative) {
 }
 
 void MPVPlayer::seek_to_percentage(String pos) {
+	if (cached_clip) {
+		clip_time = CLAMP(pos.to_float() / 100.0 * cached_clip->duration, 0.0, cached_clip->duration);
+		return;
+	}
 	if (!mpv) {
 		ERR_PRINT("MPV not initialized");
 		return;
@@ -397,6 +1717,10 @@ void MPVPlayer::seek_to_percentage(String pos) {
 }
 
 void MPVPlayer::seek_content_pos(String pos) {
+	if (cached_clip) {
+		clip_time = CLAMP(pos.to_float(), 0.0, cached_clip->duration);
+		return;
+	}
 	if (!mpv) {
 		ERR_PRINT("MPV not initialized");
 		return;
@@ -417,6 +1741,7 @@ double MPVPlayer::get_volume() const {
 }
 
 void MPVPlayer::set_loop(bool p_loop) {
+	loop_enabled = p_loop;
 	if (!mpv)
 		return;
 	const char *value = p_loop ? "inf" : "no";
@@ -424,6 +1749,8 @@ void MPVPlayer::set_loop(bool p_loop) {
 }
 
 bool MPVPlayer::get_loop() const {
+	if (!mpv)
+		return loop_enabled;
 	String loop_value = get_mpv_property("loop").operator String();
 	return loop_value == "inf";
 }
@@ -515,6 +1842,8 @@ void MPVPlayer::set_subtitle_track(String id) {
 }
 
 double MPVPlayer::get_duration() const {
+	if (cached_clip)
+		return cached_clip->duration;
 	if (!mpv)
 		return 0.0;
 	
@@ -528,6 +1857,8 @@ double MPVPlayer::get_duration() const {
 }
 
 double MPVPlayer::get_percentage_pos() const {
+	if (cached_clip)
+		return cached_clip->duration > 0.0 ? clip_time / cached_clip->duration * 100.0 : 0.0;
 	if (!mpv)
 		return 0.0;
 
@@ -706,6 +2037,8 @@ double MPVPlayer::get_subtitle_delay() const {
 }
 
 double MPVPlayer::get_time_pos() const {
+	if (cached_clip)
+		return clip_time;
 	if (!mpv)
 		return 0.0;
 
@@ -723,6 +2056,8 @@ bool MPVPlayer::is_playing() const {
 }
 
 bool MPVPlayer::is_paused() const {
+	if (cached_clip)
+		return clip_paused;
 	if (!mpv)
 		return true;
 
@@ -733,7 +2068,39 @@ bool MPVPlayer::is_paused() const {
 	return value != 0;
 }
 
+double MPVPlayer::get_estimated_time_pos() const {
+	if (!time_pos_valid || paused_state || is_buffering)
+		return current_time;
+	double elapsed = (Time::get_singleton()->get_ticks_usec() - time_pos_stamp_usec) / 1000000.0;
+	return current_time + elapsed * playback_speed;
+}
+
+void MPVPlayer::set_playback_speed(double p_speed) {
+	if (p_speed <= 0.0)
+		return;
+	if (!mpv) {
+		// Released by the clip cache; the clip runs at playback_speed
+		if (cached_clip) {
+			playback_speed = p_speed;
+		}
+		return;
+	}
+	mpv_set_property_async(mpv, 0, "speed", MPV_FORMAT_DOUBLE, &p_speed);
+}
+
+void MPVPlayer::seek_exact(double p_time) {
+	if (!mpv)
+		return;
+	CharString time = String::num(p_time, 6).utf8();
+	const char *cmd[] = { "seek", time.get_data(), "absolute+exact", nullptr };
+	mpv_command_async(mpv, 0, cmd);
+}
+
 void MPVPlayer::set_time_pos(double pos) {
+	if (cached_clip) {
+		clip_time = CLAMP(pos, 0.0, cached_clip->duration);
+		return;
+	}
 	if (!mpv) {
 		ERR_PRINT("MPV not initialized");
 		return;
@@ -781,9 +2148,83 @@ void MPVPlayer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_time_pos", "pos"), &MPVPlayer::set_time_pos);
 	ClassDB::bind_method(D_METHOD("set_target_texture_rect", "rect"), &MPVPlayer::set_target_texture_rect);
+	ClassDB::bind_method(D_METHOD("get_texture"), &MPVPlayer::get_texture);
+	ClassDB::bind_method(D_METHOD("get_preview_texture"), &MPVPlayer::get_preview_texture);
+	ClassDB::bind_method(D_METHOD("add_target_texture_rect", "rect", "preview"), &MPVPlayer::add_target_texture_rect, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("remove_target_texture_rect", "rect"), &MPVPlayer::remove_target_texture_rect);
+	ClassDB::bind_method(D_METHOD("add_target_material", "material", "parameter", "preview"), &MPVPlayer::add_target_material, DEFVAL("texture"), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("remove_target_material", "material"), &MPVPlayer::remove_target_material);
+	ClassDB::bind_method(D_METHOD("clear_targets"), &MPVPlayer::clear_targets);
+	ClassDB::bind_method(D_METHOD("set_generate_mipmaps", "enabled"), &MPVPlayer::set_generate_mipmaps);
+	ClassDB::bind_method(D_METHOD("get_generate_mipmaps"), &MPVPlayer::get_generate_mipmaps);
+	ClassDB::bind_method(D_METHOD("set_preview_enabled", "enabled"), &MPVPlayer::set_preview_enabled);
+	ClassDB::bind_method(D_METHOD("is_preview_enabled"), &MPVPlayer::is_preview_enabled);
+
+	ClassDB::bind_method(D_METHOD("set_scheduled_rendering", "enabled"), &MPVPlayer::set_scheduled_rendering);
+	ClassDB::bind_method(D_METHOD("is_scheduled_rendering"), &MPVPlayer::is_scheduled_rendering);
+	ClassDB::bind_method(D_METHOD("set_render_priority", "priority"), &MPVPlayer::set_render_priority);
+	ClassDB::bind_method(D_METHOD("get_render_priority"), &MPVPlayer::get_render_priority);
+	ClassDB::bind_method(D_METHOD("get_render_stats"), &MPVPlayer::get_render_stats);
+
+	ClassDB::bind_method(D_METHOD("get_visibility_state"), &MPVPlayer::get_visibility_state);
+	ClassDB::bind_method(D_METHOD("set_visibility_throttling", "enabled"), &MPVPlayer::set_visibility_throttling);
+	ClassDB::bind_method(D_METHOD("is_visibility_throttling"), &MPVPlayer::is_visibility_throttling);
+	ClassDB::bind_method(D_METHOD("set_suspend_delay", "seconds"), &MPVPlayer::set_suspend_delay);
+	ClassDB::bind_method(D_METHOD("get_suspend_delay"), &MPVPlayer::get_suspend_delay);
+	ClassDB::bind_method(D_METHOD("set_suspend_mode", "mode"), &MPVPlayer::set_suspend_mode);
+	ClassDB::bind_method(D_METHOD("get_suspend_mode"), &MPVPlayer::get_suspend_mode);
+	ClassDB::bind_method(D_METHOD("set_small_tile_area", "area"), &MPVPlayer::set_small_tile_area);
+	ClassDB::bind_method(D_METHOD("get_small_tile_area"), &MPVPlayer::get_small_tile_area);
+	ClassDB::bind_method(D_METHOD("set_reduced_render_interval", "interval"), &MPVPlayer::set_reduced_render_interval);
+	ClassDB::bind_method(D_METHOD("get_reduced_render_interval"), &MPVPlayer::get_reduced_render_interval);
+
+	ClassDB::bind_method(D_METHOD("set_adaptive_quality", "enabled"), &MPVPlayer::set_adaptive_quality);
+	ClassDB::bind_method(D_METHOD("is_adaptive_quality"), &MPVPlayer::is_adaptive_quality);
+	ClassDB::bind_method(D_METHOD("set_quality_level", "level"), &MPVPlayer::set_quality_level);
+	ClassDB::bind_method(D_METHOD("get_quality_level"), &MPVPlayer::get_quality_level);
+	ClassDB::bind_method(D_METHOD("get_quality_level_name"), &MPVPlayer::get_quality_level_name);
+	ClassDB::bind_method(D_METHOD("set_target_frame_budget_ms", "budget"), &MPVPlayer::set_target_frame_budget_ms);
+	ClassDB::bind_method(D_METHOD("get_target_frame_budget_ms"), &MPVPlayer::get_target_frame_budget_ms);
+
+	ClassDB::bind_method(D_METHOD("set_composite_mode", "mode"), &MPVPlayer::set_composite_mode);
+	ClassDB::bind_method(D_METHOD("get_composite_mode"), &MPVPlayer::get_composite_mode);
+	ClassDB::bind_method(D_METHOD("set_key_color", "color"), &MPVPlayer::set_key_color);
+	ClassDB::bind_method(D_METHOD("get_key_color"), &MPVPlayer::get_key_color);
+	ClassDB::bind_method(D_METHOD("set_key_tolerance", "tolerance"), &MPVPlayer::set_key_tolerance);
+	ClassDB::bind_method(D_METHOD("get_key_tolerance"), &MPVPlayer::get_key_tolerance);
+	ClassDB::bind_method(D_METHOD("set_key_softness", "softness"), &MPVPlayer::set_key_softness);
+	ClassDB::bind_method(D_METHOD("get_key_softness"), &MPVPlayer::get_key_softness);
+	ClassDB::bind_method(D_METHOD("set_spill_suppression", "amount"), &MPVPlayer::set_spill_suppression);
+	ClassDB::bind_method(D_METHOD("get_spill_suppression"), &MPVPlayer::get_spill_suppression);
+	ClassDB::bind_static_method("MPVPlayer", D_METHOD("get_compositor_isa"), &MPVPlayer::get_compositor_isa);
+	ClassDB::bind_static_method("MPVPlayer", D_METHOD("benchmark_compositor", "mode", "width", "height", "iterations"), &MPVPlayer::benchmark_compositor, DEFVAL(1920), DEFVAL(1080), DEFVAL(100));
+	ClassDB::bind_static_method("MPVPlayer", D_METHOD("verify_compositor", "width", "height"), &MPVPlayer::verify_compositor, DEFVAL(256), DEFVAL(64));
+	ClassDB::bind_static_method("MPVPlayer", D_METHOD("get_allocation_counts"), &MPVPlayer::get_allocation_counts);
+	ClassDB::bind_static_method("MPVPlayer", D_METHOD("reset_allocation_counts"), &MPVPlayer::reset_allocation_counts);
+
+	ClassDB::bind_method(D_METHOD("set_clip_cache_enabled", "enabled"), &MPVPlayer::set_clip_cache_enabled);
+	ClassDB::bind_method(D_METHOD("is_clip_cache_enabled"), &MPVPlayer::is_clip_cache_enabled);
+	ClassDB::bind_method(D_METHOD("set_clip_cache_max_duration", "seconds"), &MPVPlayer::set_clip_cache_max_duration);
+	ClassDB::bind_method(D_METHOD("get_clip_cache_max_duration"), &MPVPlayer::get_clip_cache_max_duration);
+	ClassDB::bind_method(D_METHOD("set_clip_cache_scale", "scale"), &MPVPlayer::set_clip_cache_scale);
+	ClassDB::bind_method(D_METHOD("get_clip_cache_scale"), &MPVPlayer::get_clip_cache_scale);
+	ClassDB::bind_method(D_METHOD("set_clip_cache_compress", "enabled"), &MPVPlayer::set_clip_cache_compress);
+	ClassDB::bind_method(D_METHOD("is_clip_cache_compress"), &MPVPlayer::is_clip_cache_compress);
+	ClassDB::bind_method(D_METHOD("set_clip_cache_release_mpv", "enabled"), &MPVPlayer::set_clip_cache_release_mpv);
+	ClassDB::bind_method(D_METHOD("is_clip_cache_release_mpv"), &MPVPlayer::is_clip_cache_release_mpv);
+	ClassDB::bind_method(D_METHOD("is_playing_from_cache"), &MPVPlayer::is_playing_from_cache);
+
+	ClassDB::bind_method(D_METHOD("set_presentation_queue_size", "size"), &MPVPlayer::set_presentation_queue_size);
+	ClassDB::bind_method(D_METHOD("get_presentation_queue_size"), &MPVPlayer::get_presentation_queue_size);
+	ClassDB::bind_method(D_METHOD("set_presentation_latency_ms", "latency"), &MPVPlayer::set_presentation_latency_ms);
+	ClassDB::bind_method(D_METHOD("get_presentation_latency_ms"), &MPVPlayer::get_presentation_latency_ms);
+	ClassDB::bind_method(D_METHOD("get_presentation_stats"), &MPVPlayer::get_presentation_stats);
+	ClassDB::bind_method(D_METHOD("reset_presentation_stats"), &MPVPlayer::reset_presentation_stats);
 	ClassDB::bind_method(D_METHOD("get_audio_tracks"), &MPVPlayer::get_audio_tracks);
 	ClassDB::bind_method(D_METHOD("get_subtitle_tracks"), &MPVPlayer::get_subtitle_tracks);
-	//ClassDB::bind_method(D_METHOD("set_playback_speed", "speed"), &MPVPlayer::set_playback_speed);
+	ClassDB::bind_method(D_METHOD("set_playback_speed", "speed"), &MPVPlayer::set_playback_speed);
+	ClassDB::bind_method(D_METHOD("get_playback_speed"), &MPVPlayer::get_playback_speed);
+	ClassDB::bind_method(D_METHOD("get_estimated_time_pos"), &MPVPlayer::get_estimated_time_pos);
 	ClassDB::bind_method(D_METHOD("set_native_subtitles_enabled", "enabled"), &MPVPlayer::set_native_subtitles_enabled);
 	ClassDB::bind_method(D_METHOD("add_subtitle_file", "path", "title", "lang"), &MPVPlayer::add_subtitle_file, DEFVAL(""), DEFVAL(""));
 	ClassDB::bind_method(D_METHOD("restart"), &MPVPlayer::pause);
@@ -794,8 +2235,54 @@ void MPVPlayer::_bind_methods() {
 	// Properties
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "volume", PROPERTY_HINT_RANGE, "0,100"), "set_volume", "get_volume");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "loop"), "set_loop", "get_loop");
-
-	// Signals
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "generate_mipmaps"), "set_generate_mipmaps", "get_generate_mipmaps");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "preview_enabled"), "set_preview_enabled", "is_preview_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "scheduled_rendering"), "set_scheduled_rendering", "is_scheduled_rendering");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "render_priority"), "set_render_priority", "get_render_priority");
+
+	ADD_GROUP("Visibility", "");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "visibility_throttling"), "set_visibility_throttling", "is_visibility_throttling");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "suspend_delay", PROPERTY_HINT_RANGE, "0,60,0.1,suffix:s"), "set_suspend_delay", "get_suspend_delay");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "suspend_mode", PROPERTY_HINT_ENUM, "Skip Frames,Disable Video"), "set_suspend_mode", "get_suspend_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "small_tile_area", PROPERTY_HINT_RANGE, "0,1000000,1,suffix:px²"), "set_small_tile_area", "get_small_tile_area");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "reduced_render_interval", PROPERTY_HINT_RANGE, "1,10"), "set_reduced_render_interval", "get_reduced_render_interval");
+
+	ADD_GROUP("Quality", "");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "adaptive_quality"), "set_adaptive_quality", "is_adaptive_quality");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "quality_level", PROPERTY_HINT_ENUM, "High,Balanced,Fast,Faster,Low,Lowest"), "set_quality_level", "get_quality_level");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "target_frame_budget_ms", PROPERTY_HINT_RANGE, "1,100,0.1,suffix:ms"), "set_target_frame_budget_ms", "get_target_frame_budget_ms");
+
+	ADD_GROUP("Compositing", "");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "composite_mode", PROPERTY_HINT_ENUM, "None,Chroma Key,Packed Alpha"), "set_composite_mode", "get_composite_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::COLOR, "key_color", PROPERTY_HINT_COLOR_NO_ALPHA), "set_key_color", "get_key_color");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "key_tolerance", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_key_tolerance", "get_key_tolerance");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "key_softness", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_key_softness", "get_key_softness");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "spill_suppression", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_spill_suppression", "get_spill_suppression");
+
+	ADD_GROUP("Clip Cache", "");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "clip_cache_enabled"), "set_clip_cache_enabled", "is_clip_cache_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "clip_cache_max_duration", PROPERTY_HINT_RANGE, "0,30,0.1,suffix:s"), "set_clip_cache_max_duration", "get_clip_cache_max_duration");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "clip_cache_scale", PROPERTY_HINT_RANGE, "0.1,1,0.05"), "set_clip_cache_scale", "get_clip_cache_scale");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "clip_cache_compress"), "set_clip_cache_compress", "is_clip_cache_compress");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "clip_cache_release_mpv"), "set_clip_cache_release_mpv", "is_clip_cache_release_mpv");
+
+	ADD_GROUP("Presentation", "");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "presentation_queue_size", PROPERTY_HINT_RANGE, "0,8"), "set_presentation_queue_size", "get_presentation_queue_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "presentation_latency_ms", PROPERTY_HINT_RANGE, "-1,100,0.1,suffix:ms"), "set_presentation_latency_ms", "get_presentation_latency_ms");
+
+	BIND_ENUM_CONSTANT(VISIBILITY_VISIBLE);
+	BIND_ENUM_CONSTANT(VISIBILITY_PARTIAL);
+	BIND_ENUM_CONSTANT(VISIBILITY_HIDDEN);
+	BIND_ENUM_CONSTANT(VISIBILITY_SUSPENDED);
+	BIND_ENUM_CONSTANT(SUSPEND_SKIP_FRAMES);
+	BIND_ENUM_CONSTANT(SUSPEND_DISABLE_VIDEO);
+	BIND_ENUM_CONSTANT(COMPOSITE_NONE);
+	BIND_ENUM_CONSTANT(COMPOSITE_CHROMA_KEY);
+	BIND_ENUM_CONSTANT(COMPOSITE_PACKED_ALPHA);
+
+	// Signals. playback_finished, file_loaded, buffering_* and
+	// subtitle_changed are emitted from the player's process step, after
+	// the mpv event drain, never from inside load_file() or the drain.
 	ADD_SIGNAL(MethodInfo("playback_finished"));
 	ADD_SIGNAL(MethodInfo("file_loaded"));
 
@@ -803,4 +2290,6 @@ void MPVPlayer::_bind_methods() {
 	ADD_SIGNAL(MethodInfo("buffering_ended"));
 
 	ADD_SIGNAL(MethodInfo("subtitle_changed", PropertyInfo(Variant::STRING, "text")));
+	ADD_SIGNAL(MethodInfo("visibility_state_changed", PropertyInfo(Variant::INT, "state")));
+	ADD_SIGNAL(MethodInfo("quality_changed", PropertyInfo(Variant::INT, "level")));
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "mpv_clip_cache.h"
+#include "mpv_compositor.h"
+#include "mpv_quality_governor.h"
+
 #include <mpv/client.h>
 #include <mpv/render.h>
 #include <mpv/render_gl.h>
@@ -7,39 +11,252 @@
 #include <godot_cpp/classes/texture_rect.hpp>
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/material.hpp>
 #include <godot_cpp/classes/texture2d.hpp>
 #include <godot_cpp/variant/packed_byte_array.hpp>
 
 #include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
 
 using namespace godot;
 
+class MPVRenderScheduler;
+
 class MPVPlayer : public Control {
 	GDCLASS(MPVPlayer, Control)
 
+public:
+	enum VisibilityState {
+		VISIBILITY_VISIBLE,
+		VISIBILITY_PARTIAL, // on screen, but smaller than small_tile_area
+		VISIBILITY_HIDDEN,
+		VISIBILITY_SUSPENDED, // hidden for longer than suspend_delay
+		VISIBILITY_MAX,
+	};
+
+	enum SuspendMode {
+		SUSPEND_SKIP_FRAMES, // decode keyframes only (vd-lavc-skipframe=nonkey)
+		SUSPEND_DISABLE_VIDEO, // vid=no
+	};
+
+	enum CompositeMode {
+		COMPOSITE_NONE,
+		COMPOSITE_CHROMA_KEY,
+		COMPOSITE_PACKED_ALPHA, // colour left, alpha matte right
+	};
+
 private:
 	mpv_handle *mpv;
 	mpv_render_context *mpv_gl;
 	Ref<ImageTexture> texture;
 	Ref<Image> image;
 
-	double current_time;
+	double current_time; // last observed time-pos
+	uint64_t time_pos_stamp_usec = 0; // when current_time was observed
+	bool time_pos_valid = false;
+	bool paused_state = true;
+	double playback_speed = 1.0;
+	uint64_t playback_restarts = 0;
 	double duration;
 	int video_width;
 	int video_height;
+	int frame_width = 0; // rendered size, video size times the quality level's render scale
+	int frame_height = 0;
+
+	// Consumers of the shared texture. The texture object never changes, so
+	// any number of them cost a single render and upload per frame.
+	struct RectTarget {
+		ObjectID id;
+		bool preview;
+	};
+	struct MaterialTarget {
+		Ref<Material> material;
+		StringName parameter;
+		bool preview;
+	};
+	std::vector<RectTarget> rect_targets;
+	std::vector<MaterialTarget> material_targets;
+
+	bool generate_mipmaps = false;
+	bool preview_enabled = false;
+	Ref<ImageTexture> preview_texture;
+	Ref<Image> preview_image;
+	PackedByteArray preview_buffer;
 
-	TextureRect *target_texture_rect = nullptr;
     std::atomic<bool> texture_needs_update{ false };
 	bool is_buffering = false;
 
 	bool native_subtitles_enabled = false; // Toggle for native subtitle rendering
 	String last_subtitle_text = ""; // Cache last subtitle text to avoid duplicate signals
+	std::string last_subtitle_raw; // same text as mpv gave it, compared before converting
+
+	StringName signal_buffering_started;
+	StringName signal_buffering_ended;
+	StringName signal_subtitle_changed;
+	StringName signal_playback_finished;
+	StringName signal_file_loaded;
+
+	// Signals raised while draining mpv events, or by a clip cache hit, wait
+	// here and are emitted once the drain is over, so handlers never run
+	// inside it. Reserved up front so queueing does not allocate.
+	struct PendingSignal {
+		const StringName *name;
+		String text;
+		bool has_text;
+	};
+	std::vector<PendingSignal> pending_signals;
 
 	PackedByteArray frame_buffer;
+	PackedByteArray spare_frame_buffer; // the one the image held before the last upload
+	PackedByteArray spare_preview_buffer;
+	std::vector<uint8_t> composite_source; // full-width render for packed alpha
+	int64_t observed_width = 0; // mpv "width"/"height", kept up to date by the event loop
+	int64_t observed_height = 0;
+
+	// Render/upload bookkeeping, shared with MPVRenderScheduler
+	friend class MPVRenderScheduler;
+	friend class MPVSyncGroup;
+	struct RenderStats {
+		uint64_t frames_rendered = 0;
+		uint64_t frames_uploaded = 0;
+		uint64_t frames_dropped = 0;
+		uint64_t frames_deferred = 0;
+		uint64_t last_render_usec = 0;
+		uint64_t last_upload_usec = 0;
+		uint64_t render_usec_total = 0;
+		uint64_t upload_usec_total = 0;
+		uint64_t last_composite_usec = 0;
+		uint64_t composite_usec_total = 0;
+	};
+	RenderStats render_stats;
+	bool frame_rendered = false; // rendered into frame_buffer, not uploaded yet
+
+	// What render_frame wants logged; it may run on a pool thread, so the
+	// engine only hears about it from flush_render_log() on the main thread.
+	enum RenderIssue {
+		RENDER_ISSUE_NONE,
+		RENDER_ISSUE_NO_CONTEXT,
+		RENDER_ISSUE_NO_DIMENSIONS,
+		RENDER_ISSUE_INVALID_DIMENSIONS,
+		RENDER_ISSUE_FAILED,
+	};
+	RenderIssue render_issue = RENDER_ISSUE_NONE;
+	RenderIssue reported_render_issue = RENDER_ISSUE_NONE;
+	int render_error = 0;
+	bool video_size_changed = false;
+	int frame_buffer_resized = 0; // new size in bytes, 0 if unchanged
+	int upload_wait_ticks = 0;
+	bool scheduled_rendering = false;
+	double render_priority = 0.0;
+
+	// Visibility throttling; opt-in, and only applies to TextureRect targets
+	bool visibility_throttling = false;
+	double suspend_delay = 2.0;
+	SuspendMode suspend_mode = SUSPEND_SKIP_FRAMES;
+	double small_tile_area = 320.0 * 180.0;
+	int reduced_render_interval = 2;
+	VisibilityState visibility_state = VISIBILITY_VISIBLE;
+	double hidden_time = 0.0;
+	int reduced_frame_counter = 0;
+	String suspended_vid;
+	double visibility_time[VISIBILITY_MAX] = {};
+	uint64_t visibility_skipped[VISIBILITY_MAX] = {};
+
+	// Adaptive quality
+	MPVQualityGovernor quality_governor;
+	bool adaptive_quality = false;
+	int quality_level = MPVQualityGovernor::DEFAULT_LEVEL;
+	double render_scale = 1.0;
+	int64_t frame_drop_count = 0;
+	int64_t decoder_frame_drop_count = 0;
+	uint64_t governor_work_usec = 0;
+
+	// Compositing, applied to the frame buffer right after mpv renders it
+	CompositeMode composite_mode = COMPOSITE_NONE;
+	Color key_color = Color(0.0, 1.0, 0.0);
+	double key_tolerance = 0.3;
+	double key_softness = 0.1;
+	double spill_suppression = 0.5;
+	MPVChromaKey chroma_key;
+
+	// Clip cache: short looping clips play from decoded frames after one pass
+	bool clip_cache_enabled = false;
+	double clip_cache_max_duration = 5.0;
+	double clip_cache_scale = 1.0;
+	bool clip_cache_compress = false;
+	bool clip_cache_release_mpv = false;
+	String current_path;
+	bool loop_enabled = false;
+	std::shared_ptr<MPVCachedClip> clip_capture; // first pass being recorded
+	double clip_capture_first_pts = 0.0;
+	double clip_capture_last_pts = -1.0;
+	double clip_capture_fps = 0.0; // container fps, to spot frames missing from a pass
+	std::shared_ptr<MPVCachedClip> cached_clip; // playing from the cache
+	double clip_time = 0.0;
+	int clip_frame = -1;
+	bool clip_paused = false;
+	MPVClipDecoder clip_decoder;
+
+	// Presentation queue: frames rendered ahead, released by mpv target time
+	struct QueuedFrame {
+		PackedByteArray pixels;
+		int width = 0;
+		int height = 0;
+		int64_t target_time = 0; // mpv_get_time_us() clock
+		double pts = 0.0;
+		bool ready = false;
+	};
+	struct PresentationStats {
+		uint64_t frames_released = 0;
+		uint64_t frames_late = 0;
+		uint64_t frames_overflowed = 0;
+		uint64_t last_upload_usec = 0;
+		uint64_t samples = 0;
+		double mean_ms = 0.0;
+		double m2 = 0.0;
+		double min_ms = 0.0;
+		double max_ms = 0.0;
+	};
+	std::vector<QueuedFrame> presentation_queue;
+	int presentation_queue_size = 0;
+	double presentation_latency_ms = -1.0; // -1: one refresh interval
+	double display_refresh_rate = 60.0;
+	double presented_pts = 0.0;
+	PresentationStats presentation_stats;
 
 	void initialize_mpv();
 	void cleanup_mpv();
 	void update_frame();
+	bool render_frame();
+	void flush_render_log();
+	void upload_frame();
+	bool consume_frame_request();
+	void skip_frame();
+	VisibilityState compute_visibility() const;
+	double get_visible_target_area(bool &r_focused) const;
+	void update_visibility(double p_delta);
+	void set_visibility_state(VisibilityState p_state);
+	void apply_quality_level(int p_level, int p_previous);
+	QueuedFrame *acquire_queue_slot();
+	bool release_due_frame();
+	void update_display_refresh_rate();
+	void seek_exact(double p_time);
+	void composite_frame(const uint8_t *p_src, uint8_t *p_dst, int p_width, int p_height);
+	void update_chroma_key();
+	String get_clip_cache_key() const;
+	void begin_clip_capture();
+	void rearm_clip_capture();
+	void capture_clip_frame();
+	void start_clip_playback(const std::shared_ptr<MPVCachedClip> &p_clip, double p_time);
+	void stop_clip_playback();
+	void advance_clip(double p_delta);
+	void queue_signal(const StringName &p_signal);
+	void queue_signal(const StringName &p_signal, const String &p_text);
+	void emit_pending_signals();
+	void update_preview();
+	void bind_target_texture(const MaterialTarget &p_target);
 	static void on_mpv_events(void *ctx);
 	static void on_mpv_render_update(void *ctx);
 
@@ -62,13 +279,98 @@ public:
 
     void set_target_texture_rect(TextureRect *rect);
 
+	// Texture fan-out
+	Ref<ImageTexture> get_texture() const { return texture; }
+	Ref<ImageTexture> get_preview_texture() const { return preview_texture; }
+	void add_target_texture_rect(TextureRect *p_rect, bool p_preview);
+	void remove_target_texture_rect(TextureRect *p_rect);
+	void add_target_material(const Ref<Material> &p_material, const StringName &p_parameter, bool p_preview);
+	void remove_target_material(const Ref<Material> &p_material);
+	void clear_targets();
+
+	void set_generate_mipmaps(bool p_enabled);
+	bool get_generate_mipmaps() const { return generate_mipmaps; }
+	void set_preview_enabled(bool p_enabled);
+	bool is_preview_enabled() const { return preview_enabled; }
+
+	// Shared render scheduling
+	void set_scheduled_rendering(bool p_enabled);
+	bool is_scheduled_rendering() const { return scheduled_rendering; }
+	void set_render_priority(double p_priority);
+	double get_render_priority() const { return render_priority; }
+	Dictionary get_render_stats() const;
+
+	// Visibility throttling
+	VisibilityState get_visibility_state() const { return visibility_state; }
+	void set_visibility_throttling(bool p_enabled);
+	bool is_visibility_throttling() const { return visibility_throttling; }
+	void set_suspend_delay(double p_seconds);
+	double get_suspend_delay() const { return suspend_delay; }
+	void set_suspend_mode(SuspendMode p_mode);
+	SuspendMode get_suspend_mode() const { return suspend_mode; }
+	void set_small_tile_area(double p_area);
+	double get_small_tile_area() const { return small_tile_area; }
+	void set_reduced_render_interval(int p_interval);
+	int get_reduced_render_interval() const { return reduced_render_interval; }
+
+	// Adaptive quality
+	void set_adaptive_quality(bool p_enabled);
+	bool is_adaptive_quality() const { return adaptive_quality; }
+	void set_quality_level(int p_level);
+	int get_quality_level() const { return quality_level; }
+	String get_quality_level_name() const;
+	void set_target_frame_budget_ms(double p_budget);
+	double get_target_frame_budget_ms() const { return quality_governor.budget_ms; }
+
+	// Compositing
+	void set_composite_mode(CompositeMode p_mode);
+	CompositeMode get_composite_mode() const { return composite_mode; }
+	void set_key_color(const Color &p_color);
+	Color get_key_color() const { return key_color; }
+	void set_key_tolerance(double p_tolerance);
+	double get_key_tolerance() const { return key_tolerance; }
+	void set_key_softness(double p_softness);
+	double get_key_softness() const { return key_softness; }
+	void set_spill_suppression(double p_amount);
+	double get_spill_suppression() const { return spill_suppression; }
+	static String get_compositor_isa();
+	static Dictionary benchmark_compositor(CompositeMode p_mode, int p_width, int p_height, int p_iterations);
+	static Dictionary verify_compositor(int p_width, int p_height);
+	static Dictionary get_allocation_counts();
+	static void reset_allocation_counts();
+
+	// Clip cache
+	void set_clip_cache_enabled(bool p_enabled) { clip_cache_enabled = p_enabled; }
+	bool is_clip_cache_enabled() const { return clip_cache_enabled; }
+	void set_clip_cache_max_duration(double p_seconds);
+	double get_clip_cache_max_duration() const { return clip_cache_max_duration; }
+	void set_clip_cache_scale(double p_scale);
+	double get_clip_cache_scale() const { return clip_cache_scale; }
+	void set_clip_cache_compress(bool p_enabled) { clip_cache_compress = p_enabled; }
+	bool is_clip_cache_compress() const { return clip_cache_compress; }
+	void set_clip_cache_release_mpv(bool p_enabled) { clip_cache_release_mpv = p_enabled; }
+	bool is_clip_cache_release_mpv() const { return clip_cache_release_mpv; }
+	bool is_playing_from_cache() const { return cached_clip != nullptr; }
+
+	// Presentation queue
+	void set_presentation_queue_size(int p_size);
+	int get_presentation_queue_size() const { return presentation_queue_size; }
+	void set_presentation_latency_ms(double p_latency);
+	double get_presentation_latency_ms() const { return presentation_latency_ms; }
+	Dictionary get_presentation_stats() const;
+	void reset_presentation_stats();
+
 
 	// Property getters
-	double get_position() const { return current_time; }
+	double get_position() const { return cached_clip ? clip_time : current_time; }
 	double get_duration() const;
 	Vector2i get_video_size() const { return Vector2i(video_width, video_height); }
 
 	double get_time_pos() const;
+	// time-pos from the observed property, extrapolated to now; no mpv round trip
+	double get_estimated_time_pos() const;
+	void set_playback_speed(double p_speed);
+	double get_playback_speed() const { return playback_speed; }
 	double get_percentage_pos() const;
 
 	void set_time_pos(double pos);
@@ -106,3 +408,7 @@ public:
 	void seek_to_percentage(String pos);
 	void seek_content_pos(String pos);
 };
+
+VARIANT_ENUM_CAST(MPVPlayer::VisibilityState);
+VARIANT_ENUM_CAST(MPVPlayer::SuspendMode);
+VARIANT_ENUM_CAST(MPVPlayer::CompositeMode);
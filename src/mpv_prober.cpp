@@ -0,0 +1,439 @@
+#include "mpv_prober.h"
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+// Bumped whenever the info Dictionary changes shape, to drop stale caches.
+static const int CACHE_VERSION = 2;
+
+static Variant node_to_variant(const mpv_node &p_node) {
+	switch (p_node.format) {
+		case MPV_FORMAT_STRING:
+			return String::utf8(p_node.u.string);
+		case MPV_FORMAT_FLAG:
+			return p_node.u.flag != 0;
+		case MPV_FORMAT_INT64:
+			return p_node.u.int64;
+		case MPV_FORMAT_DOUBLE:
+			return p_node.u.double_;
+		case MPV_FORMAT_NODE_ARRAY: {
+			Array array;
+			for (int i = 0; i < p_node.u.list->num; i++) {
+				array.append(node_to_variant(p_node.u.list->values[i]));
+			}
+			return array;
+		}
+		case MPV_FORMAT_NODE_MAP: {
+			Dictionary map;
+			for (int i = 0; i < p_node.u.list->num; i++) {
+				map[String::utf8(p_node.u.list->keys[i])] = node_to_variant(p_node.u.list->values[i]);
+			}
+			return map;
+		}
+		default:
+			return Variant();
+	}
+}
+
+static Variant get_node_property(mpv_handle *p_mpv, const char *p_name) {
+	mpv_node node;
+	if (mpv_get_property(p_mpv, p_name, MPV_FORMAT_NODE, &node) < 0)
+		return Variant();
+	Variant value = node_to_variant(node);
+	mpv_free_node_contents(&node);
+	return value;
+}
+
+MPVProber::MPVProber() {
+	set_process(false);
+}
+
+MPVProber::~MPVProber() {
+	cancel();
+	if (cache_dirty) {
+		save_cache();
+	}
+}
+
+Dictionary MPVProber::probe_path(MPVHeadless &p_headless, const char *p_path, int p_timeout_ms) {
+	// No decoding at all: track selection off, null outputs, no cache and
+	// no readahead, so only the demuxer opens the file.
+	const MPVHeadless::Option options[] = {
+		{ "vo", "null" },
+		{ "ao", "null" },
+		{ "vid", "no" },
+		{ "aid", "no" },
+		{ "sid", "no" },
+		{ "cache", "no" },
+		{ "demuxer-readahead-secs", "0" },
+		{ "pause", "yes" },
+		{ "ytdl", "no" },
+		{ "load-scripts", "no" },
+		{ "terminal", "no" },
+	};
+
+	Dictionary info;
+	// Errors travel back in the result and are surfaced on the main thread
+	if (!p_headless.create(options, sizeof(options) / sizeof(options[0]), false)) {
+		info["error"] = p_headless.get_error().empty() ? String("mpv could not be created") : String::utf8(p_headless.get_error().c_str());
+		return info;
+	}
+	if (!p_headless.load_file(p_path, p_timeout_ms)) {
+		p_headless.destroy();
+		info["error"] = p_headless.get_error().empty() ? String("file could not be opened") : String::utf8(p_headless.get_error().c_str());
+		return info;
+	}
+
+	mpv_handle *mpv = p_headless.get_handle();
+
+	double duration = 0.0;
+	mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
+	info["duration"] = duration;
+
+	char *format = mpv_get_property_string(mpv, "file-format");
+	if (format) {
+		info["file_format"] = String::utf8(format);
+		mpv_free(format);
+	}
+
+	int64_t file_size = 0;
+	if (mpv_get_property(mpv, "file-size", MPV_FORMAT_INT64, &file_size) == 0) {
+		info["file_size"] = file_size;
+	}
+
+	int64_t chapters = 0;
+	mpv_get_property(mpv, "chapters", MPV_FORMAT_INT64, &chapters);
+	info["chapters"] = chapters;
+
+	Variant metadata = get_node_property(mpv, "metadata");
+	info["metadata"] = metadata.get_type() == Variant::DICTIONARY ? metadata : Variant(Dictionary());
+
+	// Tracks are listed from the demuxer even though none are selected.
+	// The first video and audio track fill in the summary fields.
+	Array video_tracks;
+	Array audio_tracks;
+	Array subtitle_tracks;
+	Variant track_list = get_node_property(mpv, "track-list");
+	if (track_list.get_type() == Variant::ARRAY) {
+		Array tracks = track_list;
+		for (int i = 0; i < tracks.size(); i++) {
+			if (tracks[i].get_type() != Variant::DICTIONARY)
+				continue;
+			Dictionary track = tracks[i];
+			String type = track.get("type", "");
+			if (type == "video" && !track.get("albumart", false)) {
+				if (video_tracks.is_empty()) {
+					info["width"] = track.get("demux-w", 0);
+					info["height"] = track.get("demux-h", 0);
+					info["fps"] = track.get("demux-fps", 0.0);
+					info["video_codec"] = track.get("codec", "");
+				}
+				video_tracks.append(track);
+			} else if (type == "audio") {
+				if (audio_tracks.is_empty()) {
+					info["audio_codec"] = track.get("codec", "");
+					info["audio_channels"] = track.get("demux-channel-count", 0);
+					info["audio_samplerate"] = track.get("demux-samplerate", 0);
+				}
+				audio_tracks.append(track);
+			} else if (type == "sub") {
+				subtitle_tracks.append(track);
+			}
+		}
+	}
+	info["video_tracks"] = video_tracks;
+	info["audio_tracks"] = audio_tracks;
+	info["subtitle_tracks"] = subtitle_tracks;
+
+	p_headless.destroy();
+	return info;
+}
+
+void MPVProber::probe(const PackedStringArray &p_paths) {
+	load_cache();
+	cancelled.store(false);
+
+	for (int i = 0; i < p_paths.size(); i++) {
+		const String &path = p_paths[i];
+		Dictionary identity = make_identity(path);
+		outstanding++;
+
+		Dictionary entry = cache.get(path, Dictionary());
+		if (!entry.is_empty() && (int64_t)entry.get("size", -1) == (int64_t)identity["size"] &&
+				(int64_t)entry.get("mtime", -1) == (int64_t)identity["mtime"]) {
+			std::lock_guard<std::mutex> lock(results_mutex);
+			pending_results.push_back({ path, Dictionary(), entry["info"] });
+			continue;
+		}
+
+		std::unique_ptr<Job> job = std::make_unique<Job>();
+		job->path = path;
+		job->identity = identity;
+		String mpv_path = path;
+		if (path.begins_with("res://") || path.begins_with("user://")) {
+			mpv_path = ProjectSettings::get_singleton()->globalize_path(path);
+		}
+		job->mpv_path = mpv_path.utf8();
+		queued.push_back(std::move(job));
+	}
+
+	if (group_task < 0) {
+		start_batch();
+	}
+	set_process(outstanding > 0);
+
+	if (outstanding == 0) {
+		// Nothing to wait for; still finish the batch so awaiting callers resume
+		call_deferred("emit_signal", "all_completed", Dictionary());
+	}
+}
+
+void MPVProber::start_batch() {
+	if (queued.empty())
+		return;
+
+	running = std::move(queued);
+	queued.clear();
+
+	group_task = WorkerThreadPool::get_singleton()->add_group_task(Callable(this, "_probe_task"), (int)running.size(),
+			max_concurrent > 0 ? max_concurrent : -1, false, "MPV probe");
+}
+
+void MPVProber::_probe_task(int p_index) {
+	Job &job = *running[p_index];
+	Result result;
+	result.path = job.path;
+	result.identity = job.identity;
+
+	if (cancelled.load()) {
+		result.info["error"] = "cancelled";
+	} else {
+		result.info = probe_path(job.headless, job.mpv_path.get_data(), timeout_ms);
+	}
+
+	std::lock_guard<std::mutex> lock(results_mutex);
+	pending_results.push_back(result);
+}
+
+void MPVProber::finish_batch() {
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_task);
+	group_task = -1;
+	running.clear();
+}
+
+void MPVProber::drain_results() {
+	std::vector<Result> results;
+	{
+		std::lock_guard<std::mutex> lock(results_mutex);
+		results.swap(pending_results);
+	}
+
+	for (Result &result : results) {
+		result.info["path"] = result.path;
+		bool ok = !result.info.has("error");
+		result.info["ok"] = ok;
+		if (!ok) {
+			UtilityFunctions::push_warning(vformat("MPV: Could not probe %s: %s", result.path, result.info["error"]));
+		}
+
+		// Failures are not cached, so a file that was still being written
+		// gets probed again next time.
+		if (ok && !result.identity.is_empty()) {
+			Dictionary entry;
+			entry["size"] = result.identity["size"];
+			entry["mtime"] = result.identity["mtime"];
+			entry["info"] = result.info;
+			cache[result.path] = entry;
+			cache_dirty = true;
+		}
+
+		batch_results[result.path] = result.info;
+		outstanding--;
+		emit_signal("probe_completed", result.path, result.info);
+	}
+}
+
+void MPVProber::_notification(int p_what) {
+	if (p_what != NOTIFICATION_PROCESS)
+		return;
+
+	if (group_task >= 0 && WorkerThreadPool::get_singleton()->is_group_task_completed(group_task)) {
+		finish_batch();
+		start_batch();
+	}
+
+	drain_results();
+
+	if (outstanding <= 0 && group_task < 0) {
+		outstanding = 0;
+		set_process(false);
+		if (cache_dirty) {
+			save_cache();
+		}
+		Dictionary results = batch_results;
+		batch_results = Dictionary();
+		emit_signal("all_completed", results);
+	}
+}
+
+void MPVProber::cancel() {
+	cancelled.store(true);
+	queued.clear();
+	if (group_task >= 0) {
+		for (std::unique_ptr<Job> &job : running) {
+			job->headless.abort();
+		}
+		finish_batch();
+	}
+
+	std::lock_guard<std::mutex> lock(results_mutex);
+	pending_results.clear();
+	batch_results = Dictionary();
+	outstanding = 0;
+	set_process(false);
+}
+
+Dictionary MPVProber::get_cached_info(const String &p_path) {
+	load_cache();
+	Dictionary entry = cache.get(p_path, Dictionary());
+	if (entry.is_empty())
+		return Dictionary();
+
+	Dictionary identity = make_identity(p_path);
+	if ((int64_t)entry.get("size", -1) != (int64_t)identity["size"] || (int64_t)entry.get("mtime", -1) != (int64_t)identity["mtime"])
+		return Dictionary();
+	return entry["info"];
+}
+
+Dictionary MPVProber::make_identity(const String &p_path) const {
+	// Streams have neither; they are cached by URL alone, as thumbnails are.
+	Dictionary identity;
+	identity["size"] = 0;
+	identity["mtime"] = 0;
+	if (FileAccess::file_exists(p_path)) {
+		Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::READ);
+		if (file.is_valid()) {
+			identity["size"] = (int64_t)file->get_length();
+			identity["mtime"] = (int64_t)FileAccess::get_modified_time(p_path);
+		}
+	}
+	return identity;
+}
+
+void MPVProber::load_cache() {
+	if (cache_loaded)
+		return;
+	cache_loaded = true;
+	cache = Dictionary();
+
+	if (!FileAccess::file_exists(cache_path))
+		return;
+
+	Variant parsed = JSON::parse_string(FileAccess::get_file_as_string(cache_path));
+	if (parsed.get_type() != Variant::DICTIONARY)
+		return;
+
+	Dictionary root = parsed;
+	if ((int)root.get("version", 0) != CACHE_VERSION || root.get("entries", Variant()).get_type() != Variant::DICTIONARY)
+		return;
+
+	// JSON has no integers; the info is stored with var_to_str instead so a
+	// cached result has the same types as a fresh probe.
+	Dictionary entries = root["entries"];
+	Array paths = entries.keys();
+	for (int i = 0; i < paths.size(); i++) {
+		Variant entry_var = entries[paths[i]];
+		if (entry_var.get_type() != Variant::DICTIONARY)
+			continue;
+		Dictionary stored = entry_var;
+		Variant info = UtilityFunctions::str_to_var(stored.get("info", String()));
+		if (info.get_type() != Variant::DICTIONARY)
+			continue;
+
+		Dictionary entry;
+		entry["size"] = (int64_t)stored.get("size", -1);
+		entry["mtime"] = (int64_t)stored.get("mtime", -1);
+		entry["info"] = info;
+		cache[paths[i]] = entry;
+	}
+}
+
+void MPVProber::save_cache() {
+	cache_dirty = false;
+
+	Error err = DirAccess::make_dir_recursive_absolute(cache_path.get_base_dir());
+	if (err != OK && err != ERR_ALREADY_EXISTS) {
+		UtilityFunctions::push_warning(vformat("MPV: Cannot create probe cache dir %s", cache_path.get_base_dir()));
+		return;
+	}
+
+	Dictionary entries;
+	Array paths = cache.keys();
+	for (int i = 0; i < paths.size(); i++) {
+		Dictionary entry = cache[paths[i]];
+		Dictionary stored;
+		stored["size"] = entry["size"];
+		stored["mtime"] = entry["mtime"];
+		stored["info"] = UtilityFunctions::var_to_str(entry["info"]);
+		entries[paths[i]] = stored;
+	}
+
+	Dictionary root;
+	root["version"] = CACHE_VERSION;
+	root["entries"] = entries;
+
+	Ref<FileAccess> file = FileAccess::open(cache_path, FileAccess::WRITE);
+	if (file.is_null()) {
+		UtilityFunctions::push_warning(vformat("MPV: Failed to write probe cache %s", cache_path));
+		return;
+	}
+	file->store_string(JSON::stringify(root));
+}
+
+void MPVProber::clear_cache() {
+	cache = Dictionary();
+	cache_loaded = true;
+	cache_dirty = false;
+	if (FileAccess::file_exists(cache_path)) {
+		DirAccess::remove_absolute(cache_path);
+	}
+}
+
+void MPVProber::set_cache_path(const String &p_path) {
+	if (p_path == cache_path)
+		return;
+	if (cache_dirty) {
+		save_cache();
+	}
+	cache_path = p_path;
+	cache_loaded = false;
+}
+
+void MPVProber::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_probe_task", "index"), &MPVProber::_probe_task);
+
+	ClassDB::bind_method(D_METHOD("probe", "paths"), &MPVProber::probe);
+	ClassDB::bind_method(D_METHOD("cancel"), &MPVProber::cancel);
+	ClassDB::bind_method(D_METHOD("is_probing"), &MPVProber::is_probing);
+	ClassDB::bind_method(D_METHOD("get_cached_info", "path"), &MPVProber::get_cached_info);
+	ClassDB::bind_method(D_METHOD("clear_cache"), &MPVProber::clear_cache);
+
+	ClassDB::bind_method(D_METHOD("set_cache_path", "path"), &MPVProber::set_cache_path);
+	ClassDB::bind_method(D_METHOD("get_cache_path"), &MPVProber::get_cache_path);
+	ClassDB::bind_method(D_METHOD("set_timeout_ms", "timeout"), &MPVProber::set_timeout_ms);
+	ClassDB::bind_method(D_METHOD("get_timeout_ms"), &MPVProber::get_timeout_ms);
+	ClassDB::bind_method(D_METHOD("set_max_concurrent", "count"), &MPVProber::set_max_concurrent);
+	ClassDB::bind_method(D_METHOD("get_max_concurrent"), &MPVProber::get_max_concurrent);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "cache_path", PROPERTY_HINT_FILE, "*.json"), "set_cache_path", "get_cache_path");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "timeout_ms", PROPERTY_HINT_RANGE, "100,60000,1,suffix:ms"), "set_timeout_ms", "get_timeout_ms");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_concurrent", PROPERTY_HINT_RANGE, "0,64"), "set_max_concurrent", "get_max_concurrent");
+
+	ADD_SIGNAL(MethodInfo("probe_completed", PropertyInfo(Variant::STRING, "path"), PropertyInfo(Variant::DICTIONARY, "info")));
+	ADD_SIGNAL(MethodInfo("all_completed", PropertyInfo(Variant::DICTIONARY, "results")));
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "mpv_headless.h"
+
+#include <godot_cpp/classes/node.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace godot;
+
+// Reads duration, size, codecs and track lists for many files at once.
+// Each path gets a short-lived mpv instance with no video or audio output
+// and no cache, run as a WorkerThreadPool group task. Results are delivered
+// on the main thread and kept in an on-disk cache keyed by path, size and
+// mtime, so probing an unchanged library again costs one stat per file.
+class MPVProber : public Node {
+	GDCLASS(MPVProber, Node)
+
+private:
+	struct Job {
+		String path;
+		CharString mpv_path;
+		Dictionary identity; // size/mtime the result is cached under
+		MPVHeadless headless;
+	};
+
+	struct Result {
+		String path;
+		Dictionary identity;
+		Dictionary info;
+	};
+
+	String cache_path = "user://mpv_probe_cache.json";
+	int timeout_ms = 10000;
+	int max_concurrent = 0;
+
+	Dictionary cache;
+	bool cache_loaded = false;
+	bool cache_dirty = false;
+
+	std::vector<std::unique_ptr<Job>> running;
+	std::vector<std::unique_ptr<Job>> queued;
+	int64_t group_task = -1;
+	std::atomic<bool> cancelled{ false };
+
+	std::mutex results_mutex;
+	std::vector<Result> pending_results;
+	Dictionary batch_results;
+	int outstanding = 0;
+
+	void start_batch();
+	void finish_batch();
+	void drain_results();
+	void _probe_task(int p_index);
+
+	Dictionary make_identity(const String &p_path) const;
+	void load_cache();
+	void save_cache();
+
+protected:
+	static void _bind_methods();
+	void _notification(int p_what);
+
+public:
+	MPVProber();
+	~MPVProber() override;
+
+	void probe(const PackedStringArray &p_paths);
+	void cancel();
+	bool is_probing() const { return outstanding > 0; }
+	Dictionary get_cached_info(const String &p_path);
+	void clear_cache();
+
+	void set_cache_path(const String &p_path);
+	String get_cache_path() const { return cache_path; }
+	void set_timeout_ms(int p_timeout) { timeout_ms = MAX(100, p_timeout); }
+	int get_timeout_ms() const { return timeout_ms; }
+	void set_max_concurrent(int p_count) { max_concurrent = MAX(0, p_count); }
+	int get_max_concurrent() const { return max_concurrent; }
+
+	// Runs in the calling thread; used by the pool tasks.
+	static Dictionary probe_path(MPVHeadless &p_headless, const char *p_path, int p_timeout_ms);
+};
@@ -0,0 +1,86 @@
+#include "mpv_quality_governor.h"
+
+// sws-scaler/zimg-scaler drive the SW renderer's scaling, sws-fast trades
+// accuracy for speed in the conversion, and the vd-lavc options cut decode
+// cost. Render scale shrinks the buffer mpv renders and we upload.
+const MPVQualityLevel MPVQualityGovernor::LEVELS[] = {
+	{ "high", "lanczos", "spline36", "no", "default", "no", 1.0 },
+	{ "balanced", "bicubic", "bicubic", "no", "default", "no", 1.0 },
+	{ "fast", "bilinear", "bilinear", "yes", "default", "no", 1.0 },
+	{ "faster", "bilinear", "bilinear", "yes", "nonref", "yes", 1.0 },
+	{ "low", "fast-bilinear", "bilinear", "yes", "all", "yes", 0.75 },
+	{ "lowest", "fast-bilinear", "point", "yes", "all", "yes", 0.5 },
+};
+
+const int MPVQualityGovernor::LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+// Matches what profile=fast used to give us.
+const int MPVQualityGovernor::DEFAULT_LEVEL = 2;
+
+void MPVQualityGovernor::reset() {
+	window_time = 0.0;
+	process_ms_sum = 0.0;
+	work_ms_sum = 0.0;
+	samples = 0;
+	last_dropped_frames = -1;
+	window_drops = 0;
+	overloaded_windows = 0;
+	underloaded_windows = 0;
+	cooldown = 0;
+}
+
+int MPVQualityGovernor::update(int p_level, double p_delta, double p_process_ms, double p_work_ms, int64_t p_dropped_frames, bool p_count_drops) {
+	if (last_dropped_frames < 0) {
+		last_dropped_frames = p_dropped_frames;
+	}
+	if (p_count_drops) {
+		window_drops += p_dropped_frames - last_dropped_frames;
+	}
+	last_dropped_frames = p_dropped_frames;
+
+	window_time += p_delta;
+	process_ms_sum += p_process_ms;
+	work_ms_sum += p_work_ms;
+	samples++;
+
+	if (window_time < WINDOW_SEC)
+		return -1;
+
+	double process_ms = process_ms_sum / samples;
+	double work_ms = work_ms_sum / samples;
+	int64_t drops = window_drops;
+
+	window_time = 0.0;
+	process_ms_sum = 0.0;
+	work_ms_sum = 0.0;
+	samples = 0;
+	window_drops = 0;
+
+	if (cooldown > 0) {
+		cooldown--;
+		return -1;
+	}
+
+	// The player's own work should stay well inside the frame budget,
+	// leaving the rest of it to the game.
+	bool overloaded = drops > 0 || process_ms > budget_ms * 1.1 || work_ms > budget_ms * 0.5;
+	bool underloaded = drops == 0 && process_ms < budget_ms * 0.8 && work_ms < budget_ms * 0.2;
+
+	overloaded_windows = overloaded ? overloaded_windows + 1 : 0;
+	underloaded_windows = underloaded ? underloaded_windows + 1 : 0;
+
+	int level = p_level;
+	if (overloaded_windows >= DEGRADE_WINDOWS && p_level < LEVEL_COUNT - 1) {
+		level = p_level + 1;
+	} else if (underloaded_windows >= UPGRADE_WINDOWS && p_level > 0) {
+		level = p_level - 1;
+	}
+
+	if (level == p_level)
+		return -1;
+
+	overloaded_windows = 0;
+	underloaded_windows = 0;
+	cooldown = COOLDOWN_WINDOWS;
+	return level;
+}
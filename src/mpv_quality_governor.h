@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+// One rung of the quality ladder. Index 0 is the best looking.
+struct MPVQualityLevel {
+	const char *name;
+	const char *sws_scaler;
+	const char *zimg_scaler;
+	const char *sws_fast;
+	const char *skiploopfilter;
+	const char *lavc_fast;
+	double render_scale;
+};
+
+// Decides when MPVPlayer should step up or down the ladder. It looks at the
+// player's render+upload time, Godot's CPU process time and mpv's drop
+// counters, averaged over short windows. The wall-clock frame delta is not
+// used: with vsync it is the refresh interval however idle the CPU is.
+// Degrading needs a few bad windows in a row, upgrading needs many good
+// ones, and every change is followed by a cooldown, so the level does not
+// oscillate.
+class MPVQualityGovernor {
+public:
+	static const MPVQualityLevel LEVELS[];
+	static const int LEVEL_COUNT;
+	static const int DEFAULT_LEVEL;
+
+	double budget_ms = 1000.0 / 60.0;
+
+	// Returns the new level, or -1 when it should stay where it is. Drops
+	// are only counted while p_count_drops is set; players rendering every
+	// other frame on purpose would otherwise look overloaded.
+	int update(int p_level, double p_delta, double p_process_ms, double p_work_ms, int64_t p_dropped_frames, bool p_count_drops);
+	void reset();
+
+private:
+	static constexpr double WINDOW_SEC = 0.5;
+	static constexpr int DEGRADE_WINDOWS = 2;
+	static constexpr int UPGRADE_WINDOWS = 8;
+	static constexpr int COOLDOWN_WINDOWS = 4;
+
+	double window_time = 0.0;
+	double process_ms_sum = 0.0;
+	double work_ms_sum = 0.0;
+	int samples = 0;
+	int64_t last_dropped_frames = -1;
+	int64_t window_drops = 0;
+
+	int overloaded_windows = 0;
+	int underloaded_windows = 0;
+	int cooldown = 0;
+};
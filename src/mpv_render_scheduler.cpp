@@ -0,0 +1,196 @@
+#include "mpv_render_scheduler.h"
+#include "mpv_player.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include <algorithm>
+
+MPVRenderScheduler *MPVRenderScheduler::singleton = nullptr;
+
+// Upload priority weights: focus dominates, then the on-screen area of the
+// player's targets (in units of a 1080p screen), then how many ticks a frame
+// has already waited.
+static const double FOCUS_WEIGHT = 100.0;
+static const double AREA_WEIGHT = 10.0;
+static const double AGE_WEIGHT = 1.0;
+
+MPVRenderScheduler::MPVRenderScheduler() {
+	singleton = this;
+	render_task = Callable(this, "_render_task");
+}
+
+MPVRenderScheduler::~MPVRenderScheduler() {
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+void MPVRenderScheduler::register_player(MPVPlayer *p_player) {
+	ERR_FAIL_NULL(p_player);
+
+	if (std::find(players.begin(), players.end(), p_player) == players.end()) {
+		players.push_back(p_player);
+	}
+	ensure_connected();
+}
+
+void MPVRenderScheduler::unregister_player(MPVPlayer *p_player) {
+	players.erase(std::remove(players.begin(), players.end(), p_player), players.end());
+}
+
+void MPVRenderScheduler::ensure_connected() {
+	SceneTree *tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+	if (!tree)
+		return;
+
+	Callable tick = Callable(this, "_tick");
+	if (!tree->is_connected("process_frame", tick)) {
+		tree->connect("process_frame", tick);
+	}
+}
+
+double MPVRenderScheduler::get_upload_priority(const MPVPlayer *p_player) const {
+	// The player's own Control does not draw the frame, so only what its
+	// consumers actually show on screen counts.
+	bool focused = false;
+	double area = p_player->get_visible_target_area(focused);
+
+	return p_player->render_priority + (focused ? FOCUS_WEIGHT : 0.0) +
+			AREA_WEIGHT * area / (1920.0 * 1080.0) + AGE_WEIGHT * p_player->upload_wait_ticks;
+}
+
+void MPVRenderScheduler::_render_task(int p_index) {
+	render_list[p_index]->render_frame();
+}
+
+void MPVRenderScheduler::_tick() {
+	if (players.empty())
+		return;
+
+	ticks++;
+
+	// Collect players whose mpv render context has a new frame
+	render_list.clear();
+	for (MPVPlayer *player : players) {
+		if (player->consume_frame_request()) {
+			render_list.push_back(player);
+		}
+	}
+
+	uint64_t render_start = Time::get_singleton()->get_ticks_usec();
+	if (render_list.size() == 1) {
+		render_list[0]->render_frame();
+	} else if (!render_list.empty()) {
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		int64_t group = pool->add_group_task(render_task, (int)render_list.size(),
+				max_render_threads > 0 ? max_render_threads : -1, true, "MPV render");
+		pool->wait_for_group_task_completion(group);
+	}
+	last_render_usec = Time::get_singleton()->get_ticks_usec() - render_start;
+	last_rendered = (int)render_list.size();
+
+	// Back on the main thread; log whatever the render pass ran into
+	for (MPVPlayer *player : render_list) {
+		player->flush_render_log();
+	}
+
+	// Upload by priority until the budget is spent; at least one per tick
+	upload_list.clear();
+	for (MPVPlayer *player : players) {
+		if (player->presentation_queue_size > 0) {
+			player->release_due_frame();
+		}
+		if (player->frame_rendered) {
+			upload_list.push_back({ get_upload_priority(player), player });
+		}
+	}
+	std::sort(upload_list.begin(), upload_list.end(), [](const UploadCandidate &a, const UploadCandidate &b) {
+		return a.priority > b.priority;
+	});
+
+	uint64_t upload_start = Time::get_singleton()->get_ticks_usec();
+	uint64_t budget_usec = (uint64_t)(upload_budget_ms * 1000.0);
+	last_uploaded = 0;
+	last_deferred = 0;
+
+	for (const UploadCandidate &candidate : upload_list) {
+		MPVPlayer *player = candidate.player;
+		if (last_uploaded > 0 && Time::get_singleton()->get_ticks_usec() - upload_start >= budget_usec) {
+			player->upload_wait_ticks++;
+			player->render_stats.frames_deferred++;
+			last_deferred++;
+			continue;
+		}
+
+		player->upload_frame();
+		player->upload_wait_ticks = 0;
+		last_uploaded++;
+	}
+	last_upload_usec = Time::get_singleton()->get_ticks_usec() - upload_start;
+}
+
+void MPVRenderScheduler::set_upload_budget_ms(double p_budget) {
+	upload_budget_ms = MAX(0.0, p_budget);
+}
+
+void MPVRenderScheduler::set_max_render_threads(int p_threads) {
+	max_render_threads = MAX(0, p_threads);
+}
+
+Dictionary MPVRenderScheduler::get_stats() const {
+	uint64_t rendered = 0;
+	uint64_t uploaded = 0;
+	uint64_t dropped = 0;
+	uint64_t deferred = 0;
+	for (const MPVPlayer *player : players) {
+		rendered += player->render_stats.frames_rendered;
+		uploaded += player->render_stats.frames_uploaded;
+		dropped += player->render_stats.frames_dropped;
+		deferred += player->render_stats.frames_deferred;
+	}
+
+	Dictionary stats;
+	stats["players"] = (int64_t)players.size();
+	stats["ticks"] = ticks;
+	stats["frames_rendered"] = rendered;
+	stats["frames_uploaded"] = uploaded;
+	stats["frames_dropped"] = dropped;
+	stats["frames_deferred"] = deferred;
+	stats["last_tick_rendered"] = last_rendered;
+	stats["last_tick_uploaded"] = last_uploaded;
+	stats["last_tick_deferred"] = last_deferred;
+	stats["last_tick_render_usec"] = last_render_usec;
+	stats["last_tick_upload_usec"] = last_upload_usec;
+	stats["upload_budget_ms"] = upload_budget_ms;
+	return stats;
+}
+
+Array MPVRenderScheduler::get_player_stats() const {
+	Array result;
+	for (MPVPlayer *player : players) {
+		Dictionary stats = player->get_render_stats();
+		stats["player"] = player;
+		stats["priority"] = get_upload_priority(player);
+		result.append(stats);
+	}
+	return result;
+}
+
+void MPVRenderScheduler::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_tick"), &MPVRenderScheduler::_tick);
+	ClassDB::bind_method(D_METHOD("_render_task", "index"), &MPVRenderScheduler::_render_task);
+
+	ClassDB::bind_method(D_METHOD("set_upload_budget_ms", "budget"), &MPVRenderScheduler::set_upload_budget_ms);
+	ClassDB::bind_method(D_METHOD("get_upload_budget_ms"), &MPVRenderScheduler::get_upload_budget_ms);
+	ClassDB::bind_method(D_METHOD("set_max_render_threads", "threads"), &MPVRenderScheduler::set_max_render_threads);
+	ClassDB::bind_method(D_METHOD("get_max_render_threads"), &MPVRenderScheduler::get_max_render_threads);
+	ClassDB::bind_method(D_METHOD("get_stats"), &MPVRenderScheduler::get_stats);
+	ClassDB::bind_method(D_METHOD("get_player_stats"), &MPVRenderScheduler::get_player_stats);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "upload_budget_ms", PROPERTY_HINT_RANGE, "0,33,0.1,suffix:ms"), "set_upload_budget_ms", "get_upload_budget_ms");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_render_threads", PROPERTY_HINT_RANGE, "0,64"), "set_max_render_threads", "get_max_render_threads");
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <godot_cpp/classes/object.hpp>
+
+#include <vector>
+
+using namespace godot;
+
+class MPVPlayer;
+
+// Engine singleton that renders and uploads frames for every MPVPlayer with
+// scheduled_rendering enabled. Once per process frame it renders all pending
+// frames in parallel on the WorkerThreadPool, then uploads them on the main
+// thread in priority order until the upload budget is spent. A frame that
+// misses the budget waits for the next tick; if a newer one arrives first,
+// the older one is dropped rather than queued.
+class MPVRenderScheduler : public Object {
+	GDCLASS(MPVRenderScheduler, Object)
+
+private:
+	static MPVRenderScheduler *singleton;
+
+	struct UploadCandidate {
+		double priority;
+		MPVPlayer *player;
+	};
+
+	std::vector<MPVPlayer *> players;
+	std::vector<MPVPlayer *> render_list;
+	std::vector<UploadCandidate> upload_list;
+	Callable render_task; // built once; a Callable per tick would intern the name each time
+
+	double upload_budget_ms = 4.0;
+	int max_render_threads = 0;
+
+	uint64_t ticks = 0;
+	int last_rendered = 0;
+	int last_uploaded = 0;
+	int last_deferred = 0;
+	uint64_t last_render_usec = 0;
+	uint64_t last_upload_usec = 0;
+
+	void ensure_connected();
+	double get_upload_priority(const MPVPlayer *p_player) const;
+	void _tick();
+	void _render_task(int p_index);
+
+protected:
+	static void _bind_methods();
+
+public:
+	static MPVRenderScheduler *get_singleton() { return singleton; }
+
+	MPVRenderScheduler();
+	~MPVRenderScheduler() override;
+
+	void register_player(MPVPlayer *p_player);
+	void unregister_player(MPVPlayer *p_player);
+
+	void set_upload_budget_ms(double p_budget);
+	double get_upload_budget_ms() const { return upload_budget_ms; }
+	void set_max_render_threads(int p_threads);
+	int get_max_render_threads() const { return max_render_threads; }
+
+	Dictionary get_stats() const;
+	Array get_player_stats() const;
+};
@@ -0,0 +1,316 @@
+#include "mpv_sync_group.h"
+#include "mpv_player.h"
+
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+// A pending seek that never reports back is given up on after this long.
+static const uint64_t SEEK_TIMEOUT_USEC = 2000000;
+
+MPVSyncGroup::MPVSyncGroup() {
+	set_process(true);
+}
+
+MPVSyncGroup::Member *MPVSyncGroup::find_member(MPVPlayer *p_player) {
+	for (Member &member : members) {
+		if (member.id == p_player->get_instance_id())
+			return &member;
+	}
+	return nullptr;
+}
+
+MPVPlayer *MPVSyncGroup::get_master_player() const {
+	return Object::cast_to<MPVPlayer>(ObjectDB::get_instance(master_id));
+}
+
+void MPVSyncGroup::add_member(MPVPlayer *p_player) {
+	ERR_FAIL_NULL(p_player);
+	if (find_member(p_player))
+		return;
+
+	Member member;
+	member.id = p_player->get_instance_id();
+	member.speed = p_player->get_playback_speed();
+	members.push_back(member);
+}
+
+void MPVSyncGroup::remove_member(MPVPlayer *p_player) {
+	ERR_FAIL_NULL(p_player);
+	for (size_t i = 0; i < members.size(); i++) {
+		if (members[i].id == p_player->get_instance_id()) {
+			members.erase(members.begin() + i);
+			return;
+		}
+	}
+}
+
+void MPVSyncGroup::clear_members() {
+	members.clear();
+}
+
+Array MPVSyncGroup::get_members() const {
+	Array result;
+	for (const Member &member : members) {
+		Object *player = ObjectDB::get_instance(member.id);
+		if (player) {
+			result.append(player);
+		}
+	}
+	return result;
+}
+
+void MPVSyncGroup::set_master(MPVPlayer *p_player) {
+	master_id = p_player ? p_player->get_instance_id() : ObjectID();
+	if (p_player) {
+		clock_source = CLOCK_MASTER;
+	}
+}
+
+void MPVSyncGroup::set_clock_source(ClockSource p_source) {
+	clock_source = p_source;
+}
+
+void MPVSyncGroup::set_external_time(double p_time, double p_rate) {
+	external_time = p_time;
+	external_rate = MAX(0.0, p_rate);
+	external_stamp_usec = Time::get_singleton()->get_ticks_usec();
+}
+
+bool MPVSyncGroup::get_reference(double &r_time, double &r_rate, bool &r_paused) const {
+	if (clock_source == CLOCK_EXTERNAL) {
+		if (external_stamp_usec == 0)
+			return false;
+		double elapsed = (Time::get_singleton()->get_ticks_usec() - external_stamp_usec) / 1000000.0;
+		r_time = external_time + elapsed * external_rate;
+		r_rate = external_rate > 0.0 ? external_rate : 1.0;
+		r_paused = external_rate == 0.0;
+		return true;
+	}
+
+	MPVPlayer *master = get_master_player();
+	if (!master || !master->time_pos_valid)
+		return false;
+	r_time = master->get_estimated_time_pos();
+	r_rate = master->get_playback_speed();
+	r_paused = master->paused_state;
+	return true;
+}
+
+double MPVSyncGroup::get_reference_time() const {
+	double time = 0.0;
+	double rate = 1.0;
+	bool paused = false;
+	get_reference(time, rate, paused);
+	return time;
+}
+
+void MPVSyncGroup::update_member(Member &p_member, MPVPlayer *p_player, double p_reference, double p_rate, bool p_paused, uint64_t p_now) {
+	// paused_state only changes when mpv's property event comes back, so
+	// send each request once instead of on every tick until then.
+	if (sync_pause) {
+		if (p_player->paused_state == p_paused) {
+			p_member.pause_requested = -1;
+		} else if (p_member.pause_requested != (int)p_paused) {
+			if (p_paused) {
+				p_player->pause();
+			} else {
+				p_player->play();
+			}
+			p_member.pause_requested = p_paused;
+		}
+	}
+
+	if (p_member.seek_pending) {
+		bool restarted = p_player->playback_restarts != p_member.seek_restarts;
+		if (!restarted && p_now - p_member.seek_start_usec < SEEK_TIMEOUT_USEC)
+			return;
+		p_member.seek_pending = false;
+		if (restarted) {
+			p_member.seek_latency = (p_now - p_member.seek_start_usec) / 1000000.0;
+		}
+		// Restart from the new position rather than the pre-seek average
+		p_member.offset = 0.0;
+		return;
+	}
+
+	if (!p_player->time_pos_valid || p_player->paused_state || p_paused)
+		return;
+
+	// Each time-pos was stamped when its event was drained, which adds up to
+	// a frame of noise per reading; smoothing averages that out.
+	double raw = p_player->get_estimated_time_pos() - p_reference;
+	p_member.raw_offset = raw;
+	p_member.offset += (raw - p_member.offset) * smoothing;
+	p_member.ticks++;
+
+	double abs_offset = Math::abs(p_member.offset);
+	p_member.max_abs_offset = MAX(p_member.max_abs_offset, abs_offset);
+
+	if (Math::abs(raw) > hard_seek_threshold) {
+		// Too far to catch up by speed; land where the reference will be
+		// once the seek completes.
+		p_player->seek_exact(p_reference + p_member.seek_latency * p_rate);
+		p_player->set_playback_speed(p_rate);
+		p_member.speed = p_rate;
+		p_member.seek_pending = true;
+		p_member.seek_restarts = p_player->playback_restarts;
+		p_member.seek_start_usec = p_now;
+		p_member.hard_seeks++;
+		return;
+	}
+
+	double tolerance = tolerance_ms / 1000.0;
+	if (abs_offset <= tolerance) {
+		p_member.ticks_in_tolerance++;
+	}
+
+	// Proportional correction that closes the gap over correction_time,
+	// with a dead band so players in sync run at exactly the reference rate.
+	double adjust = 0.0;
+	if (abs_offset > tolerance * 0.5) {
+		adjust = CLAMP(p_member.offset / correction_time, -max_speed_adjust, max_speed_adjust);
+		p_member.ticks_corrected++;
+	}
+
+	double speed = p_rate * (1.0 - adjust);
+	if (Math::abs(speed - p_member.speed) > 0.0001) {
+		p_player->set_playback_speed(speed);
+		p_member.speed = speed;
+	}
+}
+
+void MPVSyncGroup::_process(double delta) {
+	double reference = 0.0;
+	double rate = 1.0;
+	bool paused = false;
+	if (!get_reference(reference, rate, paused))
+		return;
+
+	uint64_t now = Time::get_singleton()->get_ticks_usec();
+	for (Member &member : members) {
+		if (member.id == master_id && clock_source == CLOCK_MASTER)
+			continue;
+		MPVPlayer *player = Object::cast_to<MPVPlayer>(ObjectDB::get_instance(member.id));
+		if (!player)
+			continue;
+		update_member(member, player, reference, rate, paused, now);
+	}
+}
+
+void MPVSyncGroup::set_tolerance_ms(double p_tolerance) {
+	tolerance_ms = MAX(0.0, p_tolerance);
+}
+
+void MPVSyncGroup::set_hard_seek_threshold(double p_threshold) {
+	hard_seek_threshold = MAX(0.01, p_threshold);
+}
+
+void MPVSyncGroup::set_max_speed_adjust(double p_adjust) {
+	max_speed_adjust = CLAMP(p_adjust, 0.0, 0.5);
+}
+
+void MPVSyncGroup::set_correction_time(double p_time) {
+	correction_time = MAX(0.05, p_time);
+}
+
+void MPVSyncGroup::set_smoothing(double p_smoothing) {
+	smoothing = CLAMP(p_smoothing, 0.01, 1.0);
+}
+
+Dictionary MPVSyncGroup::get_stats() const {
+	double max_offset = 0.0;
+	double max_raw_offset = 0.0;
+	double abs_sum = 0.0;
+	int count = 0;
+	uint64_t hard_seeks = 0;
+	for (const Member &member : members) {
+		if (member.id == master_id && clock_source == CLOCK_MASTER)
+			continue;
+		max_offset = MAX(max_offset, Math::abs(member.offset));
+		max_raw_offset = MAX(max_raw_offset, Math::abs(member.raw_offset));
+		abs_sum += Math::abs(member.offset);
+		hard_seeks += member.hard_seeks;
+		count++;
+	}
+
+	Dictionary stats;
+	stats["members"] = (int64_t)members.size();
+	stats["followers"] = count;
+	stats["reference_time"] = get_reference_time();
+	stats["max_offset_ms"] = max_offset * 1000.0;
+	stats["max_raw_offset_ms"] = max_raw_offset * 1000.0; // this tick, unsmoothed
+	stats["mean_abs_offset_ms"] = count > 0 ? abs_sum * 1000.0 / count : 0.0;
+	stats["hard_seeks"] = hard_seeks;
+	return stats;
+}
+
+Array MPVSyncGroup::get_member_stats() const {
+	Array result;
+	for (const Member &member : members) {
+		Dictionary stats;
+		stats["player"] = ObjectDB::get_instance(member.id);
+		stats["master"] = member.id == master_id && clock_source == CLOCK_MASTER;
+		stats["offset_ms"] = member.offset * 1000.0;
+		stats["raw_offset_ms"] = member.raw_offset * 1000.0;
+		stats["max_abs_offset_ms"] = member.max_abs_offset * 1000.0;
+		stats["speed"] = member.speed;
+		stats["in_tolerance_ratio"] = member.ticks > 0 ? (double)member.ticks_in_tolerance / member.ticks : 1.0;
+		stats["corrected_ratio"] = member.ticks > 0 ? (double)member.ticks_corrected / member.ticks : 0.0;
+		stats["hard_seeks"] = member.hard_seeks;
+		stats["seek_latency_ms"] = member.seek_latency * 1000.0;
+		result.append(stats);
+	}
+	return result;
+}
+
+void MPVSyncGroup::reset_stats() {
+	for (Member &member : members) {
+		member.max_abs_offset = 0.0;
+		member.ticks = 0;
+		member.ticks_in_tolerance = 0;
+		member.ticks_corrected = 0;
+		member.hard_seeks = 0;
+	}
+}
+
+void MPVSyncGroup::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("add_member", "player"), &MPVSyncGroup::add_member);
+	ClassDB::bind_method(D_METHOD("remove_member", "player"), &MPVSyncGroup::remove_member);
+	ClassDB::bind_method(D_METHOD("clear_members"), &MPVSyncGroup::clear_members);
+	ClassDB::bind_method(D_METHOD("get_members"), &MPVSyncGroup::get_members);
+
+	ClassDB::bind_method(D_METHOD("set_master", "player"), &MPVSyncGroup::set_master);
+	ClassDB::bind_method(D_METHOD("get_master"), &MPVSyncGroup::get_master);
+	ClassDB::bind_method(D_METHOD("set_clock_source", "source"), &MPVSyncGroup::set_clock_source);
+	ClassDB::bind_method(D_METHOD("get_clock_source"), &MPVSyncGroup::get_clock_source);
+	ClassDB::bind_method(D_METHOD("set_external_time", "time", "rate"), &MPVSyncGroup::set_external_time, DEFVAL(1.0));
+	ClassDB::bind_method(D_METHOD("get_reference_time"), &MPVSyncGroup::get_reference_time);
+
+	ClassDB::bind_method(D_METHOD("set_tolerance_ms", "tolerance"), &MPVSyncGroup::set_tolerance_ms);
+	ClassDB::bind_method(D_METHOD("get_tolerance_ms"), &MPVSyncGroup::get_tolerance_ms);
+	ClassDB::bind_method(D_METHOD("set_hard_seek_threshold", "seconds"), &MPVSyncGroup::set_hard_seek_threshold);
+	ClassDB::bind_method(D_METHOD("get_hard_seek_threshold"), &MPVSyncGroup::get_hard_seek_threshold);
+	ClassDB::bind_method(D_METHOD("set_max_speed_adjust", "adjust"), &MPVSyncGroup::set_max_speed_adjust);
+	ClassDB::bind_method(D_METHOD("get_max_speed_adjust"), &MPVSyncGroup::get_max_speed_adjust);
+	ClassDB::bind_method(D_METHOD("set_correction_time", "seconds"), &MPVSyncGroup::set_correction_time);
+	ClassDB::bind_method(D_METHOD("get_correction_time"), &MPVSyncGroup::get_correction_time);
+	ClassDB::bind_method(D_METHOD("set_smoothing", "smoothing"), &MPVSyncGroup::set_smoothing);
+	ClassDB::bind_method(D_METHOD("get_smoothing"), &MPVSyncGroup::get_smoothing);
+	ClassDB::bind_method(D_METHOD("set_sync_pause", "enabled"), &MPVSyncGroup::set_sync_pause);
+	ClassDB::bind_method(D_METHOD("is_sync_pause"), &MPVSyncGroup::is_sync_pause);
+
+	ClassDB::bind_method(D_METHOD("get_stats"), &MPVSyncGroup::get_stats);
+	ClassDB::bind_method(D_METHOD("get_member_stats"), &MPVSyncGroup::get_member_stats);
+	ClassDB::bind_method(D_METHOD("reset_stats"), &MPVSyncGroup::reset_stats);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "clock_source", PROPERTY_HINT_ENUM, "Master,External"), "set_clock_source", "get_clock_source");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "tolerance_ms", PROPERTY_HINT_RANGE, "0,100,0.1,suffix:ms"), "set_tolerance_ms", "get_tolerance_ms");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "hard_seek_threshold", PROPERTY_HINT_RANGE, "0.01,10,0.01,suffix:s"), "set_hard_seek_threshold", "get_hard_seek_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_speed_adjust", PROPERTY_HINT_RANGE, "0,0.5,0.001"), "set_max_speed_adjust", "get_max_speed_adjust");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "correction_time", PROPERTY_HINT_RANGE, "0.05,10,0.05,suffix:s"), "set_correction_time", "get_correction_time");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "smoothing", PROPERTY_HINT_RANGE, "0.01,1,0.01"), "set_smoothing", "get_smoothing");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "sync_pause"), "set_sync_pause", "is_sync_pause");
+
+	BIND_ENUM_CONSTANT(CLOCK_MASTER);
+	BIND_ENUM_CONSTANT(CLOCK_EXTERNAL);
+}
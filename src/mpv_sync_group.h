@@ -0,0 +1,102 @@
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+
+#include <vector>
+
+using namespace godot;
+
+class MPVPlayer;
+
+// Keeps several MPVPlayers on one clock. The reference is either a master
+// player or an external clock fed through set_external_time(). Followers
+// that drift past the tolerance get a small speed change until they catch
+// up; only a gap beyond hard_seek_threshold is closed with an exact seek.
+// Drift is measured from each player's observed time-pos, extrapolated to
+// the current tick, so a tick costs no mpv round trips.
+class MPVSyncGroup : public Node {
+	GDCLASS(MPVSyncGroup, Node)
+
+public:
+	enum ClockSource {
+		CLOCK_MASTER,
+		CLOCK_EXTERNAL,
+	};
+
+private:
+	struct Member {
+		ObjectID id;
+		double raw_offset = 0.0; // seconds, positive when ahead of the reference
+		double offset = 0.0; // smoothed
+		double max_abs_offset = 0.0;
+		double speed = 1.0; // last speed we asked for
+		uint64_t ticks = 0;
+		uint64_t ticks_in_tolerance = 0;
+		uint64_t ticks_corrected = 0;
+		uint64_t hard_seeks = 0;
+		bool seek_pending = false;
+		uint64_t seek_restarts = 0; // player's restart count when the seek was sent
+		uint64_t seek_start_usec = 0;
+		double seek_latency = 0.0; // how long the last seek took, used as lead
+		int pause_requested = -1; // pause state last sent and not yet reported back, -1 if none
+	};
+
+	std::vector<Member> members;
+	ObjectID master_id;
+	ClockSource clock_source = CLOCK_MASTER;
+
+	double external_time = 0.0;
+	double external_rate = 1.0;
+	uint64_t external_stamp_usec = 0;
+
+	double tolerance_ms = 8.0;
+	double hard_seek_threshold = 0.5;
+	double max_speed_adjust = 0.05;
+	double correction_time = 1.0;
+	double smoothing = 0.2;
+	bool sync_pause = true;
+
+	Member *find_member(MPVPlayer *p_player);
+	MPVPlayer *get_master_player() const;
+	bool get_reference(double &r_time, double &r_rate, bool &r_paused) const;
+	void update_member(Member &p_member, MPVPlayer *p_player, double p_reference, double p_rate, bool p_paused, uint64_t p_now);
+
+protected:
+	static void _bind_methods();
+
+public:
+	MPVSyncGroup();
+
+	virtual void _process(double delta) override;
+
+	void add_member(MPVPlayer *p_player);
+	void remove_member(MPVPlayer *p_player);
+	void clear_members();
+	Array get_members() const;
+
+	void set_master(MPVPlayer *p_player);
+	MPVPlayer *get_master() const { return get_master_player(); }
+	void set_clock_source(ClockSource p_source);
+	ClockSource get_clock_source() const { return clock_source; }
+	void set_external_time(double p_time, double p_rate = 1.0);
+	double get_reference_time() const;
+
+	void set_tolerance_ms(double p_tolerance);
+	double get_tolerance_ms() const { return tolerance_ms; }
+	void set_hard_seek_threshold(double p_threshold);
+	double get_hard_seek_threshold() const { return hard_seek_threshold; }
+	void set_max_speed_adjust(double p_adjust);
+	double get_max_speed_adjust() const { return max_speed_adjust; }
+	void set_correction_time(double p_time);
+	double get_correction_time() const { return correction_time; }
+	void set_smoothing(double p_smoothing);
+	double get_smoothing() const { return smoothing; }
+	void set_sync_pause(bool p_enabled) { sync_pause = p_enabled; }
+	bool is_sync_pause() const { return sync_pause; }
+
+	Dictionary get_stats() const;
+	Array get_member_stats() const;
+	void reset_stats();
+};
+
+VARIANT_ENUM_CAST(MPVSyncGroup::ClockSource);
@@ -0,0 +1,380 @@
+#include "mpv_thumbnailer.h"
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <cmath>
+
+MPVThumbnailer::MPVThumbnailer() {
+	set_process(false);
+}
+
+MPVThumbnailer::~MPVThumbnailer() {
+	cancel();
+}
+
+void MPVThumbnailer::generate(const String &p_path) {
+	cancel();
+
+	// Setters only affect the next job
+	job_tile_width = tile_width;
+	job_interval = interval;
+	job_columns = columns;
+	job_max_tiles = max_tiles;
+
+	current_path = p_path;
+	cache_key = make_cache_key(p_path);
+	tiles_done = 0;
+	done_indices.clear();
+	done_times.clear();
+	tile_height = 0;
+	tile_count = 0;
+	duration = 0.0;
+	atlas_image.unref();
+
+	if (load_from_cache()) {
+		UtilityFunctions::print(vformat("MPV: Thumbnails for %s loaded from cache", p_path));
+		emit_signal("atlas_ready");
+		return;
+	}
+
+	String mpv_path = p_path;
+	if (p_path.begins_with("res://") || p_path.begins_with("user://")) {
+		mpv_path = ProjectSettings::get_singleton()->globalize_path(p_path);
+	}
+
+	layout_ready.store(false);
+	worker_finished.store(false);
+	headless.reset_abort();
+	generating = true;
+	set_process(true);
+
+	worker = std::thread(&MPVThumbnailer::run_worker, this, mpv_path.utf8());
+}
+
+void MPVThumbnailer::cancel() {
+	if (worker.joinable()) {
+		headless.abort();
+		worker.join();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(tiles_mutex);
+		pending_tiles.clear();
+	}
+
+	generating = false;
+	set_process(false);
+}
+
+void MPVThumbnailer::run_worker(CharString p_path) {
+	// Keyframe-only seeks with the loop filter skipped: a preview tile only
+	// needs to be recognisable, and this keeps each seek to a single decode.
+	const MPVHeadless::Option options[] = {
+		{ "vo", "libmpv" },
+		{ "aid", "no" },
+		{ "ao", "null" },
+		{ "sid", "no" },
+		{ "pause", "yes" },
+		{ "keep-open", "yes" },
+		{ "hr-seek", "no" },
+		{ "hwdec", "no" },
+		{ "cache", "no" },
+		{ "vd-lavc-skiploopfilter", "all" },
+		{ "sws-scaler", "fast-bilinear" },
+		{ "terminal", "no" },
+		{ "osd-level", "0" },
+	};
+
+	if (!headless.create(options, sizeof(options) / sizeof(options[0]), true) ||
+			!headless.load_file(p_path.get_data(), 15000)) {
+		headless.destroy();
+		worker_finished.store(true);
+		return;
+	}
+
+	mpv_handle *mpv = headless.get_handle();
+
+	double length = 0.0;
+	mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &length);
+
+	// Display size accounts for non-square pixels; fall back to 16:9.
+	int64_t display_width = 16;
+	int64_t display_height = 9;
+	if (headless.wait_for_frame(5000)) {
+		int64_t w = 0;
+		int64_t h = 0;
+		if (mpv_get_property(mpv, "dwidth", MPV_FORMAT_INT64, &w) == 0 &&
+				mpv_get_property(mpv, "dheight", MPV_FORMAT_INT64, &h) == 0 && w > 0 && h > 0) {
+			display_width = w;
+			display_height = h;
+		}
+	}
+
+	duration = length;
+	tile_height = MAX(1, (int)std::lround(double(job_tile_width) * double(display_height) / double(display_width)));
+	tile_count = length > 0.0 ? CLAMP((int)std::floor(length / job_interval) + 1, 1, job_max_tiles) : 1;
+	layout_ready.store(true);
+
+	const int stride = job_tile_width * 4;
+	for (int i = 0; i < tile_count && !headless.is_aborted(); i++) {
+		double time = MIN(i * job_interval, MAX(0.0, length - 0.5));
+
+		if (!headless.seek(time, false, 5000)) {
+			continue;
+		}
+
+		Tile tile;
+		tile.index = i;
+		tile.time = time;
+		tile.pixels.resize(stride * tile_height);
+		if (!headless.render(job_tile_width, tile_height, stride, tile.pixels.ptrw())) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(tiles_mutex);
+		pending_tiles.push_back(std::move(tile));
+	}
+
+	headless.destroy();
+	worker_finished.store(true);
+}
+
+void MPVThumbnailer::_notification(int p_what) {
+	if (p_what != NOTIFICATION_PROCESS || !generating)
+		return;
+
+	bool finished = worker_finished.load();
+	drain_tiles();
+
+	if (finished) {
+		worker.join();
+		drain_tiles();
+		finish_job();
+	}
+}
+
+void MPVThumbnailer::drain_tiles() {
+	if (!layout_ready.load())
+		return;
+
+	if (atlas_image.is_null()) {
+		int rows = (tile_count + job_columns - 1) / job_columns;
+		atlas_image = Image::create_empty(MIN(tile_count, job_columns) * job_tile_width, rows * tile_height, false, Image::FORMAT_RGBA8);
+		if (atlas_texture.is_null()) {
+			atlas_texture = ImageTexture::create_from_image(atlas_image);
+		} else {
+			atlas_texture->set_image(atlas_image);
+		}
+	}
+
+	std::vector<Tile> tiles;
+	{
+		std::lock_guard<std::mutex> lock(tiles_mutex);
+		tiles.swap(pending_tiles);
+	}
+
+	if (tiles.empty())
+		return;
+
+	for (const Tile &tile : tiles) {
+		Ref<Image> tile_image = Image::create_from_data(job_tile_width, tile_height, false, Image::FORMAT_RGBA8, tile.pixels);
+		Rect2i region = get_tile_region(tile.index);
+		atlas_image->blit_rect(tile_image, Rect2i(0, 0, job_tile_width, tile_height), region.position);
+		tiles_done++;
+		done_indices.push_back(tile.index);
+		done_times.push_back(tile.time);
+		emit_signal("tile_ready", tile.index, tile.time, region);
+	}
+
+	atlas_texture->update(atlas_image);
+}
+
+void MPVThumbnailer::finish_job() {
+	generating = false;
+	set_process(false);
+
+	// The worker has been joined, so what its mpv instance ran into can be
+	// read and logged here
+	for (const std::string &warning : headless.get_warnings()) {
+		UtilityFunctions::push_warning(vformat("MPV: %s", String::utf8(warning.c_str())));
+	}
+	if (!headless.get_error().empty()) {
+		UtilityFunctions::push_error(vformat("MPV: Thumbnails for %s: %s", current_path, String::utf8(headless.get_error().c_str())));
+	}
+
+	if (tiles_done == 0) {
+		UtilityFunctions::push_warning(vformat("MPV: No thumbnails could be extracted from %s", current_path));
+		return;
+	}
+
+	// A run that hit an mpv error may have lost tiles it would get next time
+	if (headless.get_error().empty()) {
+		save_to_cache();
+	}
+	emit_signal("atlas_ready");
+}
+
+String MPVThumbnailer::make_cache_key(const String &p_path) const {
+	String identity = p_path;
+
+	// Size and mtime catch files replaced in place; streams are keyed by URL.
+	if (FileAccess::file_exists(p_path)) {
+		Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::READ);
+		if (file.is_valid()) {
+			identity += vformat("|%d|%d", (int64_t)file->get_length(), (int64_t)FileAccess::get_modified_time(p_path));
+		}
+	}
+
+	identity += vformat("|%d|%f|%d|%d", job_tile_width, job_interval, job_columns, job_max_tiles);
+	return identity.md5_text();
+}
+
+bool MPVThumbnailer::load_from_cache() {
+	String base = cache_dir.path_join(cache_key);
+	if (!FileAccess::file_exists(base + ".json") || !FileAccess::file_exists(base + ".png"))
+		return false;
+
+	Variant parsed = JSON::parse_string(FileAccess::get_file_as_string(base + ".json"));
+	if (parsed.get_type() != Variant::DICTIONARY)
+		return false;
+	Dictionary meta = parsed;
+
+	Ref<Image> cached = Image::load_from_file(base + ".png");
+	if (cached.is_null() || cached->is_empty())
+		return false;
+
+	if (cached->get_format() != Image::FORMAT_RGBA8) {
+		cached->convert(Image::FORMAT_RGBA8);
+	}
+
+	// Only the tiles listed as present are announced; an entry without the
+	// list predates it and cannot tell holes apart, so it is regenerated.
+	Array indices = meta.get("tiles", Array());
+	Array times = meta.get("times", Array());
+	tile_height = meta.get("tile_height", 0);
+	tile_count = meta.get("tile_count", 0);
+	duration = meta.get("duration", 0.0);
+	if (tile_height <= 0 || tile_count <= 0 || indices.is_empty() || indices.size() != times.size())
+		return false;
+
+	for (int i = 0; i < indices.size(); i++) {
+		int index = indices[i];
+		if (index < 0 || index >= tile_count)
+			return false;
+		done_indices.push_back(index);
+		done_times.push_back(times[i]);
+	}
+	tiles_done = done_indices.size();
+
+	atlas_image = cached;
+	if (atlas_texture.is_null()) {
+		atlas_texture = ImageTexture::create_from_image(atlas_image);
+	} else {
+		atlas_texture->set_image(atlas_image);
+	}
+
+	for (int i = 0; i < done_indices.size(); i++) {
+		emit_signal("tile_ready", done_indices[i], done_times[i], get_tile_region(done_indices[i]));
+	}
+	return true;
+}
+
+void MPVThumbnailer::save_to_cache() {
+	if (atlas_image.is_null())
+		return;
+
+	Error err = DirAccess::make_dir_recursive_absolute(cache_dir);
+	if (err != OK && err != ERR_ALREADY_EXISTS) {
+		UtilityFunctions::push_warning(vformat("MPV: Cannot create thumbnail cache dir %s", cache_dir));
+		return;
+	}
+
+	String base = cache_dir.path_join(cache_key);
+	if (atlas_image->save_png(base + ".png") != OK) {
+		UtilityFunctions::push_warning(vformat("MPV: Failed to write thumbnail atlas %s.png", base));
+		return;
+	}
+
+	Dictionary meta;
+	meta["path"] = current_path;
+	meta["tile_width"] = job_tile_width;
+	meta["tile_height"] = tile_height;
+	meta["tile_count"] = tile_count;
+	meta["tiles_done"] = tiles_done;
+	meta["tiles"] = done_indices;
+	meta["times"] = done_times;
+	meta["columns"] = job_columns;
+	meta["interval"] = job_interval;
+	meta["duration"] = duration;
+
+	Ref<FileAccess> file = FileAccess::open(base + ".json", FileAccess::WRITE);
+	if (file.is_valid()) {
+		file->store_string(JSON::stringify(meta));
+	}
+}
+
+Rect2i MPVThumbnailer::get_tile_region(int p_index) const {
+	if (p_index < 0 || p_index >= tile_count)
+		return Rect2i();
+	return Rect2i((p_index % job_columns) * job_tile_width, (p_index / job_columns) * tile_height, job_tile_width, tile_height);
+}
+
+Rect2i MPVThumbnailer::get_tile_region_for_time(double p_time) const {
+	if (tile_count <= 0)
+		return Rect2i();
+	return get_tile_region(CLAMP((int)(p_time / job_interval), 0, tile_count - 1));
+}
+
+void MPVThumbnailer::set_tile_width(int p_width) {
+	tile_width = MAX(8, p_width);
+}
+
+void MPVThumbnailer::set_interval(double p_interval) {
+	interval = MAX(0.1, p_interval);
+}
+
+void MPVThumbnailer::set_columns(int p_columns) {
+	columns = MAX(1, p_columns);
+}
+
+void MPVThumbnailer::set_max_tiles(int p_max_tiles) {
+	max_tiles = MAX(1, p_max_tiles);
+}
+
+void MPVThumbnailer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("generate", "path"), &MPVThumbnailer::generate);
+	ClassDB::bind_method(D_METHOD("cancel"), &MPVThumbnailer::cancel);
+	ClassDB::bind_method(D_METHOD("is_generating"), &MPVThumbnailer::is_generating);
+
+	ClassDB::bind_method(D_METHOD("get_atlas_texture"), &MPVThumbnailer::get_atlas_texture);
+	ClassDB::bind_method(D_METHOD("get_tile_count"), &MPVThumbnailer::get_tile_count);
+	ClassDB::bind_method(D_METHOD("get_tiles_done"), &MPVThumbnailer::get_tiles_done);
+	ClassDB::bind_method(D_METHOD("get_tile_size"), &MPVThumbnailer::get_tile_size);
+	ClassDB::bind_method(D_METHOD("get_tile_region", "index"), &MPVThumbnailer::get_tile_region);
+	ClassDB::bind_method(D_METHOD("get_tile_region_for_time", "time"), &MPVThumbnailer::get_tile_region_for_time);
+
+	ClassDB::bind_method(D_METHOD("set_tile_width", "width"), &MPVThumbnailer::set_tile_width);
+	ClassDB::bind_method(D_METHOD("get_tile_width"), &MPVThumbnailer::get_tile_width);
+	ClassDB::bind_method(D_METHOD("set_interval", "interval"), &MPVThumbnailer::set_interval);
+	ClassDB::bind_method(D_METHOD("get_interval"), &MPVThumbnailer::get_interval);
+	ClassDB::bind_method(D_METHOD("set_columns", "columns"), &MPVThumbnailer::set_columns);
+	ClassDB::bind_method(D_METHOD("get_columns"), &MPVThumbnailer::get_columns);
+	ClassDB::bind_method(D_METHOD("set_max_tiles", "max_tiles"), &MPVThumbnailer::set_max_tiles);
+	ClassDB::bind_method(D_METHOD("get_max_tiles"), &MPVThumbnailer::get_max_tiles);
+	ClassDB::bind_method(D_METHOD("set_cache_dir", "dir"), &MPVThumbnailer::set_cache_dir);
+	ClassDB::bind_method(D_METHOD("get_cache_dir"), &MPVThumbnailer::get_cache_dir);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_width", PROPERTY_HINT_RANGE, "8,1024"), "set_tile_width", "get_tile_width");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "interval", PROPERTY_HINT_RANGE, "0.1,600,0.1,suffix:s"), "set_interval", "get_interval");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "columns", PROPERTY_HINT_RANGE, "1,64"), "set_columns", "get_columns");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_tiles", PROPERTY_HINT_RANGE, "1,4096"), "set_max_tiles", "get_max_tiles");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "cache_dir", PROPERTY_HINT_DIR), "set_cache_dir", "get_cache_dir");
+
+	ADD_SIGNAL(MethodInfo("tile_ready", PropertyInfo(Variant::INT, "index"), PropertyInfo(Variant::FLOAT, "time"), PropertyInfo(Variant::RECT2I, "region")));
+	ADD_SIGNAL(MethodInfo("atlas_ready"));
+}
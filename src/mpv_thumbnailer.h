@@ -0,0 +1,105 @@
+#pragma once
+
+#include "mpv_headless.h"
+
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_float64_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace godot;
+
+// Builds seek-bar preview atlases on a worker thread with its own headless
+// mpv instance. Tiles are streamed to the main thread as they are decoded
+// and the finished atlas is cached on disk, keyed by file identity.
+class MPVThumbnailer : public Node {
+	GDCLASS(MPVThumbnailer, Node)
+
+private:
+	struct Tile {
+		int index;
+		double time;
+		PackedByteArray pixels;
+	};
+
+	int tile_width = 160;
+	double interval = 10.0;
+	int columns = 10;
+	int max_tiles = 200;
+	String cache_dir = "user://mpv_thumbnails";
+
+	// Settings of the job in flight, snapshotted by generate() so the
+	// worker never reads a value a setter is changing.
+	int job_tile_width = 160;
+	double job_interval = 10.0;
+	int job_columns = 10;
+	int job_max_tiles = 200;
+
+	// Job layout, written by the worker before the first tile is queued.
+	int tile_height = 0;
+	int tile_count = 0;
+	double duration = 0.0;
+
+	Ref<Image> atlas_image;
+	Ref<ImageTexture> atlas_texture;
+	String current_path;
+	String cache_key;
+	int tiles_done = 0;
+	// Which tiles made it into the atlas and at what time; a seek or render
+	// that fails leaves its tile out.
+	PackedInt32Array done_indices;
+	PackedFloat64Array done_times;
+
+	std::thread worker;
+	MPVHeadless headless;
+	std::mutex tiles_mutex;
+	std::vector<Tile> pending_tiles;
+	std::atomic<bool> layout_ready{ false };
+	std::atomic<bool> worker_finished{ false };
+	bool generating = false;
+
+	void run_worker(CharString p_path);
+	void drain_tiles();
+	void finish_job();
+
+	String make_cache_key(const String &p_path) const;
+	bool load_from_cache();
+	void save_to_cache();
+
+protected:
+	static void _bind_methods();
+	void _notification(int p_what);
+
+public:
+	MPVThumbnailer();
+	~MPVThumbnailer() override;
+
+	void generate(const String &p_path);
+	void cancel();
+	bool is_generating() const { return generating; }
+
+	Ref<ImageTexture> get_atlas_texture() const { return atlas_texture; }
+	int get_tile_count() const { return tile_count; }
+	int get_tiles_done() const { return tiles_done; }
+	Vector2i get_tile_size() const { return Vector2i(job_tile_width, tile_height); }
+	Rect2i get_tile_region(int p_index) const;
+	Rect2i get_tile_region_for_time(double p_time) const;
+
+	void set_tile_width(int p_width);
+	int get_tile_width() const { return tile_width; }
+	void set_interval(double p_interval);
+	double get_interval() const { return interval; }
+	void set_columns(int p_columns);
+	int get_columns() const { return columns; }
+	void set_max_tiles(int p_max_tiles);
+	int get_max_tiles() const { return max_tiles; }
+	void set_cache_dir(const String &p_dir) { cache_dir = p_dir; }
+	String get_cache_dir() const { return cache_dir; }
+};
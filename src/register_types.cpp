@@ -1,14 +1,24 @@
 #include "register_types.h"
 
 #include <gdextension_interface.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
+#include "mpv_audio_player.h"
+#include "mpv_clip_cache.h"
+#include "mpv_frame_extractor.h"
 #include "mpv_player.h"
+#include "mpv_prober.h"
+#include "mpv_render_scheduler.h"
+#include "mpv_sync_group.h"
+#include "mpv_thumbnailer.h"
 
 using namespace godot;
 
+static MPVRenderScheduler *render_scheduler = nullptr;
+static MPVClipCache *clip_cache = nullptr;
 
 void initialize_godot_mpv_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
@@ -16,12 +26,37 @@ void initialize_godot_mpv_module(ModuleInitializationLevel p_level) {
 	}
 
 	ClassDB::register_class<MPVPlayer>();
+	ClassDB::register_class<MPVAudioPlayer>();
+	ClassDB::register_class<MPVThumbnailer>();
+	ClassDB::register_class<MPVFrameExtractor>();
+	ClassDB::register_class<MPVProber>();
+	ClassDB::register_class<MPVRenderScheduler>();
+	ClassDB::register_class<MPVSyncGroup>();
+	ClassDB::register_class<MPVClipCache>();
+
+	render_scheduler = memnew(MPVRenderScheduler);
+	Engine::get_singleton()->register_singleton("MPVRenderScheduler", render_scheduler);
+
+	clip_cache = memnew(MPVClipCache);
+	Engine::get_singleton()->register_singleton("MPVClipCache", clip_cache);
 }
 
 void uninitialize_godot_mpv_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+
+	if (render_scheduler) {
+		Engine::get_singleton()->unregister_singleton("MPVRenderScheduler");
+		memdelete(render_scheduler);
+		render_scheduler = nullptr;
+	}
+
+	if (clip_cache) {
+		Engine::get_singleton()->unregister_singleton("MPVClipCache");
+		memdelete(clip_cache);
+		clip_cache = nullptr;
+	}
 }
 
 